@@ -0,0 +1,363 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <Urho3D/Audio/Audio.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/MathDefs.h>
+
+#include "../../src/components/Position.h"
+#include "../../src/components/Sound.h"
+#include "../../src/components/SoundListener.h"
+#include "../../src/state/GameState.h"
+#include "../../src/systems/UrhoSystem.h"
+
+/**
+ * Measures the main thread cost of the audio path: the sound providers in
+ * UrhoSystem, the voice manager, Urho3D's per source update and the round trip
+ * of E_SOUNDFINISHED through GameState.
+ *
+ * Runs headless with a fixed time step. The audio output is opened on SDL's
+ * dummy driver, which needs no sound card, so the mixing thread competes for
+ * the CPU as it would in the game. With `-nomixer` Urho3D's audio stays
+ * uninitialized, so sources are synced but never mixed.
+ *
+ * Urho3D only advances and finishes sources while its output is open, so
+ * there is no cost per finish with `-nomixer`. When the output is open and
+ * the spawn phase saw no sound finish, the benchmark fails.
+ *
+ * Options:
+ *   -frames N     frames measured per phase (600)
+ *   -spawns N     one-shots started per frame in the spawn phase (4)
+ *   -emitters N   entities the one-shots are spread over (16)
+ *   -loops N      looping sounds playing throughout (32)
+ *   -reusable     play the one-shots on reusable entities
+ *   -nomixer      leave the audio output closed
+ *
+ * The idle phase only plays the loops and the music. The spawn phase adds the
+ * one-shots, what it costs on top of the idle phase is put down to them.
+ */
+
+namespace {
+/// Simulated time per frame.
+constexpr float TIME_STEP = 1.0f / 60.0f;
+/// Frames run before measuring, to get resources loaded and instances made.
+constexpr unsigned WARMUP_FRAMES = 60;
+
+struct AudioBenchSettings {
+  unsigned frames = 600;
+  unsigned spawnsPerFrame = 4;
+  unsigned emitters = 16;
+  unsigned loops = 32;
+  bool isReusable = false;
+  bool useMixer = true;
+};
+
+struct PhaseStats {
+  const char *name;
+  unsigned frames = 0;
+  unsigned spawns = 0;
+  unsigned finishes = 0;
+  /// All times in microseconds.
+  long long frameTime = 0;
+  long long spawnTime = 0;
+  long long systemTime = 0;
+  long long audioTime = 0;
+};
+
+AudioBenchSettings ParseSettings() {
+  AudioBenchSettings settings;
+  const auto &arguments = Urho3D::GetArguments();
+  for (unsigned i = 0; i < arguments.Size(); ++i) {
+    const auto &argument = arguments[i];
+    bool hasValue = i + 1 < arguments.Size();
+    if (argument == "-frames" && hasValue) {
+      settings.frames = Urho3D::ToUInt(arguments[++i]);
+    } else if (argument == "-spawns" && hasValue) {
+      settings.spawnsPerFrame = Urho3D::ToUInt(arguments[++i]);
+    } else if (argument == "-emitters" && hasValue) {
+      settings.emitters = Urho3D::Max(1u, Urho3D::ToUInt(arguments[++i]));
+    } else if (argument == "-loops" && hasValue) {
+      settings.loops = Urho3D::ToUInt(arguments[++i]);
+    } else if (argument == "-reusable") {
+      settings.isReusable = true;
+    } else if (argument == "-nomixer") {
+      settings.useMixer = false;
+    }
+  }
+  return settings;
+}
+
+/// Per frame microseconds of `time` over `frames`.
+double PerFrame(long long time, unsigned frames) {
+  return frames ? time / 1000.0 / frames : 0.0;
+}
+} // namespace
+
+/**
+ * UrhoSystem that keeps track of how long its updates take.
+ */
+class TimedUrhoSystem : public UrhoSystem {
+public:
+  TimedUrhoSystem(Urho3D::Context *context,
+                  Urho3D::SharedPtr<Urho3D::Scene> scene, TagSet &tags)
+      : UrhoSystem(context, scene, tags), mTime(nullptr) {}
+
+  void SetAccumulator(long long *time) { mTime = time; }
+
+  void update(entityx::EntityManager &entities, entityx::EventManager &events,
+              entityx::TimeDelta dt) override {
+    Urho3D::HiresTimer timer;
+    UrhoSystem::update(entities, events, dt);
+    if (mTime) {
+      *mTime += timer.GetUSec(false);
+    }
+  }
+
+private:
+  long long *mTime;
+};
+
+class AudioBenchState : public GameState {
+  GAME_STATE(AudioBenchState)
+public:
+  AudioBenchState(Urho3D::Context *context, const AudioBenchSettings &settings)
+      : GameState(context), mSettings(settings), mFrame(0), mPhase(nullptr),
+        mNextEmitter(0) {
+    mPhases[0].name = "idle";
+    mPhases[1].name = "spawn";
+    mUrho = systems.add<TimedUrhoSystem>(context, mScene, mTags);
+    systems.configure();
+
+    mSoundBank->Load({"Sounds/BigExplosion.wav", "Sounds/Powerup.wav"});
+    mOneShot = mSoundBank->Find("Sounds/BigExplosion.wav");
+    auto loop = mSoundBank->Find("Sounds/Powerup.wav");
+
+    auto listener = CreateRenderableEntity("Listener");
+    listener.assign<Position>();
+    listener.assign<SoundListener>(listener.id());
+
+    // Everything is placed on a circle around the listener, within earshot
+    for (unsigned i = 0; i < mSettings.emitters; ++i) {
+      auto angle = 360.0f * i / mSettings.emitters;
+      auto emitter = CreateRenderableEntity("Emitter");
+      emitter.assign<Position>(20.0f * Urho3D::Cos(angle), 0.0f,
+                               20.0f * Urho3D::Sin(angle));
+      mEmitters.push_back(emitter.id());
+    }
+    for (unsigned i = 0; i < mSettings.loops; ++i) {
+      auto sound = ::Sound(loop);
+      sound.isLooped = true;
+      PlaySound(sound, mEmitters[i % mEmitters.size()]);
+    }
+    SetBackgroundMusic("Music/Ninja Gods.ogg");
+
+    SubscribeToAllEvents();
+  }
+
+  /// Prints the results, false when they are incomplete.
+  bool Report() const {
+    std::printf("%-6s %7s %7s %8s %9s %9s %9s %9s\n", "phase", "frames",
+                "spawns", "finishes", "frame ms", "spawn ms", "system ms",
+                "audio ms");
+    for (const auto &phase : mPhases) {
+      std::printf("%-6s %7u %7u %8u %9.4f %9.4f %9.4f %9.4f\n", phase.name,
+                  phase.frames, phase.spawns, phase.finishes,
+                  PerFrame(phase.frameTime, phase.frames),
+                  PerFrame(phase.spawnTime, phase.frames),
+                  PerFrame(phase.systemTime, phase.frames),
+                  PerFrame(phase.audioTime, phase.frames));
+    }
+
+    // What the spawn phase costs on top of the idle phase, scaled to the same
+    // number of frames
+    const auto &idle = mPhases[0];
+    const auto &spawn = mPhases[1];
+    auto scale = idle.frames ? double(spawn.frames) / idle.frames : 0.0;
+    auto spawnCost =
+        spawn.spawnTime + spawn.systemTime - idle.systemTime * scale;
+    auto finishCost = spawn.audioTime - idle.audioTime * scale;
+    std::printf("per spawn:  %.3f us\n",
+                spawn.spawns ? spawnCost / spawn.spawns : 0.0);
+    bool isComplete = true;
+    if (spawn.finishes) {
+      std::printf("per finish: %.3f us\n", finishCost / spawn.finishes);
+    } else {
+      std::printf("per finish: n/a\n");
+      if (spawn.spawns && mSettings.useMixer) {
+        std::fprintf(stderr, "No sound finished during the spawn phase, "
+                             "Urho3D did not update the sources.\n");
+        isComplete = false;
+      }
+    }
+
+    const auto &voices = mUrho->GetVoices();
+    std::printf("voices: %u real, %u virtual, %llu stolen\n",
+                voices.GetRealCount(), voices.GetVirtualCount(),
+                (unsigned long long)voices.GetStolenCount());
+    // NOTE: The counters were reset when the spawn phase started
+    std::printf("culled: %.2f per frame\n",
+                FrameCounters::GetStats(COUNTER_SOUNDS_CULLED).perFrame);
+    std::printf("requests: %llu, coalesced: %llu\n",
+                (unsigned long long)mSoundCoalescer.GetRequestCount(),
+                (unsigned long long)mSoundCoalescer.GetCoalescedCount());
+    return isComplete;
+  }
+
+protected:
+  void OnBeginFrame(BeginFrameData &data) override { mFrameTimer.Reset(); }
+
+  void OnUpdate(UpdateEventData &data) override {
+    if (!mPhase || mPhase == &mPhases[0]) {
+      return;
+    }
+    Urho3D::HiresTimer timer;
+    for (unsigned i = 0; i < mSettings.spawnsPerFrame; ++i) {
+      auto sound = ::Sound(mOneShot);
+      sound.isReusable = mSettings.isReusable;
+      PlaySound(sound, mEmitters[mNextEmitter]);
+      mNextEmitter = (mNextEmitter + 1) % mEmitters.size();
+    }
+    mPhase->spawnTime += timer.GetUSec(false);
+    mPhase->spawns += mSettings.spawnsPerFrame;
+  }
+
+  // NOTE: Urho3D updates the sound sources, and hence sends E_SOUNDFINISHED,
+  // during E_RENDERUPDATE which is in between these two
+  void OnPostUpdate(UpdateEventData &data) override { mAudioTimer.Reset(); }
+
+  void OnPostRenderUpdate(UpdateEventData &data) override {
+    if (mPhase) {
+      mPhase->audioTime += mAudioTimer.GetUSec(false);
+    }
+  }
+
+  void OnSoundFinished(const entityx::Entity entity,
+                       SoundFinishedEventData &data) override {
+    if (mPhase) {
+      ++mPhase->finishes;
+    }
+  }
+
+  void OnEndFrame() override {
+    if (mPhase) {
+      mPhase->frameTime += mFrameTimer.GetUSec(false);
+      ++mPhase->frames;
+    }
+    ++mFrame;
+    auto engine = GetSubsystem<Urho3D::Engine>();
+    if (mFrame == WARMUP_FRAMES) {
+      SetPhase(&mPhases[0]);
+    } else if (mFrame == WARMUP_FRAMES + mSettings.frames) {
+      SetPhase(&mPhases[1]);
+    } else if (mFrame == WARMUP_FRAMES + 2 * mSettings.frames) {
+      SetPhase(nullptr);
+      engine->Exit();
+      return;
+    }
+    engine->SetNextTimeStep(TIME_STEP);
+  }
+
+private:
+  void SetPhase(PhaseStats *phase) {
+    if (phase == &mPhases[1]) {
+      FrameCounters::Reset();
+    }
+    mPhase = phase;
+    mUrho->SetAccumulator(phase ? &phase->systemTime : nullptr);
+  }
+
+  AudioBenchSettings mSettings;
+  std::shared_ptr<TimedUrhoSystem> mUrho;
+  PhaseStats mPhases[2];
+  unsigned mFrame;
+  PhaseStats *mPhase;
+  Urho3D::HiresTimer mFrameTimer;
+  Urho3D::HiresTimer mAudioTimer;
+  SoundHandle mOneShot;
+  std::vector<entityx::Entity::Id> mEmitters;
+  std::size_t mNextEmitter;
+};
+
+class AudioBenchApp : public Urho3D::Application {
+public:
+  AudioBenchApp(Urho3D::Context *context)
+      : Application(context), settings_(ParseSettings()) {}
+
+  virtual void Setup() {
+    engineParameters_[Urho3D::EP_HEADLESS] = true;
+    engineParameters_[Urho3D::EP_SOUND] = false;
+    engineParameters_[Urho3D::EP_LOG_LEVEL] = Urho3D::LOG_WARNING;
+  }
+
+  virtual void Start() {
+    if (settings_.useMixer) {
+      // The engine doesn't open the audio output when headless
+      if (!GetSubsystem<Urho3D::Audio>()->SetMode(100, 44100, true)) {
+        ErrorExit("Could not open the dummy audio output, run with -nomixer "
+                  "to go without");
+        return;
+      }
+    }
+    engine_->SetMaxFps(0);
+    state_ = new AudioBenchState(context_, settings_);
+  }
+
+  virtual void Stop() {
+    if (state_ && !state_->Report()) {
+      exitCode_ = EXIT_FAILURE;
+    }
+    state_.Reset();
+  }
+
+private:
+  AudioBenchSettings settings_;
+  Urho3D::SharedPtr<AudioBenchState> state_;
+};
+
+int main(int argc, char **argv) {
+  // NOTE: Has to be set before the Audio subsystem initializes SDL's audio,
+  // which happens when the engine gets created
+#if defined(_WIN32)
+  if (!std::getenv("SDL_AUDIODRIVER")) {
+    _putenv_s("SDL_AUDIODRIVER", "dummy");
+  }
+#else
+  setenv("SDL_AUDIODRIVER", "dummy", 0);
+#endif
+  Urho3D::ParseArguments(argc, argv);
+  Urho3D::SharedPtr<Urho3D::Context> context(new Urho3D::Context());
+  Urho3D::SharedPtr<AudioBenchApp> application(new AudioBenchApp(context));
+  return application->Run();
+}
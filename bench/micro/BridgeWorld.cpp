@@ -0,0 +1,47 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "BridgeWorld.h"
+
+BridgeWorld::BridgeWorld()
+    : mContext(new Urho3D::Context()), mTags(events) {
+  // Nodes are created through the context's object factories
+  Urho3D::RegisterSceneLibrary(mContext);
+  mScene = new Urho3D::Scene(mContext);
+}
+
+BridgeWorld::~BridgeWorld() {
+  // NOTE: The instance components hold on to scene nodes, let go of them
+  // before the scene and its context do
+  entities.reset();
+  mScene.Reset();
+}
+
+void EntityCountsAndDensities(benchmark::internal::Benchmark *benchmark) {
+  for (int count : {64, 1024, 16384}) {
+    for (int density : {10, 50, 100}) {
+      benchmark->Args({count, density});
+    }
+  }
+  benchmark->ArgNames({"entities", "density"});
+}
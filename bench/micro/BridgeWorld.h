@@ -0,0 +1,98 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_BRIDGEWORLD_H
+#define NINPOTEST_BRIDGEWORLD_H
+
+#include <entityx/entityx.h>
+
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../../src/common/TagSet.h"
+
+/**
+ * An entityx world next to a scene living in a headless Urho3D context, with
+ * nothing but the scene library registered. Lets the bridge between the two be
+ * measured without an engine, a window or a frame loop around it.
+ */
+class BridgeWorld : public entityx::EntityX {
+public:
+  BridgeWorld();
+  ~BridgeWorld();
+
+  /**
+   * Creates `count` entities. `assign` is called for `densityPercent` percent
+   * of them, spread evenly, and `assignOthers` for the rest.
+   */
+  template <typename Assign, typename AssignOthers>
+  void Populate(int count, int densityPercent, Assign assign,
+                AssignOthers assignOthers) {
+    mEntities.reserve(mEntities.size() + count);
+    for (int i = 0; i < count; ++i) {
+      auto entity = entities.create();
+      if (IsDense(i, densityPercent)) {
+        assign(entity, i);
+      } else {
+        assignOthers(entity, i);
+      }
+      mEntities.push_back(entity);
+    }
+  }
+
+  template <typename Assign>
+  void Populate(int count, int densityPercent, Assign assign) {
+    Populate(count, densityPercent, assign, [](entityx::Entity, int) {});
+  }
+
+  Urho3D::Context &GetContext() { return *mContext; }
+
+  Urho3D::Scene &GetScene() { return *mScene; }
+
+  TagSet &GetTags() { return mTags; }
+
+  const std::vector<entityx::Entity> &GetEntities() const { return mEntities; }
+
+private:
+  static bool IsDense(int index, int densityPercent) {
+    return (index + 1) * densityPercent / 100 != index * densityPercent / 100;
+  }
+
+  Urho3D::SharedPtr<Urho3D::Context> mContext;
+  Urho3D::SharedPtr<Urho3D::Scene> mScene;
+  TagSet mTags;
+  std::vector<entityx::Entity> mEntities;
+};
+
+/**
+ * Runs a benchmark taking (entity count, density percent) as its arguments
+ * over the entity counts and densities every bridge benchmark is measured at.
+ */
+void EntityCountsAndDensities(benchmark::internal::Benchmark *benchmark);
+
+#endif // NINPOTEST_BRIDGEWORLD_H
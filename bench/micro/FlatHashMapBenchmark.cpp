@@ -0,0 +1,148 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "../../src/common/FlatHashMap.h"
+#include "AllocationCounter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+/// Pointer keys as SoundInstances sees them: heap objects, 16 byte aligned.
+std::vector<void *> MakePointerKeys(std::size_t count) {
+  std::vector<void *> keys;
+  for (std::size_t i = 0; i < count; ++i) {
+    keys.push_back(reinterpret_cast<void *>((i + 1) * 272));
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  return keys;
+}
+
+/**
+ * A burst of sounds starting and then finishing in a different order, like a
+ * round of explosions. The map is kept across iterations so the steady state
+ * is measured, not the first growth.
+ */
+template <typename Map, typename InsertFn, typename EraseFn>
+void RunChurn(benchmark::State &state, Map &map, InsertFn insert,
+              EraseFn erase) {
+  const auto keys = MakePointerKeys(static_cast<std::size_t>(state.range(0)));
+  auto eraseOrder = keys;
+  std::shuffle(eraseOrder.begin(), eraseOrder.end(), std::mt19937(11));
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      insert(map, keys[i], static_cast<int>(i));
+    }
+    for (auto key : eraseOrder) {
+      erase(map, key);
+    }
+  }
+  state.counters["allocs"] =
+      benchmark::Counter(static_cast<double>(allocations.GetCount()),
+                         benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+
+void BM_FlatHashMapChurn(benchmark::State &state) {
+  FlatHashMap<void *, int> map;
+  RunChurn(
+      state, map,
+      [](FlatHashMap<void *, int> &map, void *key, int value) {
+        map[key] = value;
+      },
+      [](FlatHashMap<void *, int> &map, void *key) {
+        auto itr = map.Find(key);
+        if (itr != map.End()) {
+          map.Erase(itr);
+        }
+      });
+}
+
+/// Node based baseline, allocating per insert like Urho3D::HashMap.
+void BM_UnorderedMapChurn(benchmark::State &state) {
+  std::unordered_map<void *, int> map;
+  RunChurn(
+      state, map,
+      [](std::unordered_map<void *, int> &map, void *key, int value) {
+        map[key] = value;
+      },
+      [](std::unordered_map<void *, int> &map, void *key) {
+        auto itr = map.find(key);
+        if (itr != map.end()) {
+          map.erase(itr);
+        }
+      });
+}
+
+const char *const ELEMENT_NAMES[] = {"text",   "pools",  "profiler",
+                                     "memory", "frames", "sounds"};
+
+void BM_FlatHashMapNamedLookup(benchmark::State &state) {
+  FlatHashMap<std::string, int, StringKeyHash, StringKeyEqual> map;
+  int value = 0;
+  for (auto name : ELEMENT_NAMES) {
+    map[std::string(name)] = value++;
+  }
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    int sum = 0;
+    for (auto name : ELEMENT_NAMES) {
+      sum += map.Find(name)->second;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  if (allocations.GetCount() != 0) {
+    state.SkipWithError("heterogeneous lookup allocated");
+  }
+}
+
+void BM_UnorderedMapNamedLookup(benchmark::State &state) {
+  std::unordered_map<std::string, int> map;
+  int value = 0;
+  for (auto name : ELEMENT_NAMES) {
+    map[std::string(name)] = value++;
+  }
+  for (auto _ : state) {
+    int sum = 0;
+    for (auto name : ELEMENT_NAMES) {
+      // The literal is copied into a temporary key first, as it is with
+      // HashMap<String, ...>; Urho3D::String has no small string buffer, so
+      // there that copy also allocates
+      auto itr = map.find(name);
+      sum += itr == map.end() ? 0 : itr->second;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+} // namespace
+
+BENCHMARK(BM_FlatHashMapChurn)->Range(16, 4096);
+BENCHMARK(BM_UnorderedMapChurn)->Range(16, 4096);
+BENCHMARK(BM_FlatHashMapNamedLookup);
+BENCHMARK(BM_UnorderedMapNamedLookup);
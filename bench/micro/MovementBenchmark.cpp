@@ -0,0 +1,128 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "../../src/components/AngularVelocity.h"
+#include "../../src/components/Direction.h"
+#include "../../src/components/Position.h"
+#include "../../src/components/Tags.h"
+#include "../../src/components/Velocity.h"
+#include "../../src/systems/MovementSystem.h"
+#include "AllocationCounter.h"
+#include "BridgeWorld.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+constexpr float TIME_STEP = 1.0f / 60.0f;
+
+/// `density` percent of the entities move and spin, the rest only have a
+/// position, like the static scenery they share the pools with.
+void BM_MovementSystemUpdate(benchmark::State &state) {
+  BridgeWorld world;
+  world.Populate(
+      static_cast<int>(state.range(0)), static_cast<int>(state.range(1)),
+      [](entityx::Entity entity, int i) {
+        entity.assign<Position>();
+        entity.assign<Direction>();
+        entity.assign<Velocity>()->value = Urho3D::Vector3(1.0f, 0.0f, 0.5f);
+        entity.assign<AngularVelocity>(static_cast<float>(i % 90), 45.0f,
+                                       0.0f);
+      },
+      [](entityx::Entity entity, int) { entity.assign<Position>(); });
+  MovementSystem movement(world.GetTags());
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    movement.update(world.entities, world.events, TIME_STEP);
+    benchmark::ClobberMemory();
+  }
+  // NOTE: entityx hands the lambdas to each() as std::function
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(allocations.GetCount()),
+      benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Same as above with half of the moving entities tagged Sleeping.
+void BM_MovementSystemUpdateSleeping(benchmark::State &state) {
+  BridgeWorld world;
+  auto &tags = world.GetTags();
+  world.Populate(
+      static_cast<int>(state.range(0)), static_cast<int>(state.range(1)),
+      [&tags](entityx::Entity entity, int i) {
+        entity.assign<Position>();
+        entity.assign<Direction>();
+        entity.assign<Velocity>()->value = Urho3D::Vector3(1.0f, 0.0f, 0.5f);
+        entity.assign<AngularVelocity>(static_cast<float>(i % 90), 45.0f,
+                                       0.0f);
+        if (i % 2 == 0) {
+          tags.Set<Sleeping>(entity);
+        }
+      },
+      [](entityx::Entity entity, int) { entity.assign<Position>(); });
+  MovementSystem movement(tags);
+  for (auto _ : state) {
+    movement.update(world.entities, world.events, TIME_STEP);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_DirectionRotate(benchmark::State &state) {
+  std::vector<Direction> directions(static_cast<std::size_t>(state.range(0)));
+  const Urho3D::Quaternion delta(0.5f, 0.75f, 0.0f);
+  for (auto _ : state) {
+    for (auto &direction : directions) {
+      direction.Rotate(delta);
+    }
+    benchmark::DoNotOptimize(directions.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Rotate plus building the delta from Euler angles, as MovementSystem does.
+void BM_DirectionRotateEuler(benchmark::State &state) {
+  std::vector<Direction> directions(static_cast<std::size_t>(state.range(0)));
+  std::vector<Urho3D::Vector3> velocities;
+  velocities.reserve(directions.size());
+  for (std::size_t i = 0; i < directions.size(); ++i) {
+    velocities.emplace_back(static_cast<float>(i % 90), 45.0f, 0.0f);
+  }
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < directions.size(); ++i) {
+      const auto &velocity = velocities[i];
+      directions[i].Rotate(Urho3D::Quaternion(velocity.x_ * TIME_STEP,
+                                              velocity.y_ * TIME_STEP,
+                                              velocity.z_ * TIME_STEP));
+    }
+    benchmark::DoNotOptimize(directions.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+BENCHMARK(BM_MovementSystemUpdate)->Apply(EntityCountsAndDensities);
+BENCHMARK(BM_MovementSystemUpdateSleeping)->Apply(EntityCountsAndDensities);
+BENCHMARK(BM_DirectionRotate)->Range(64, 16384);
+BENCHMARK(BM_DirectionRotateEuler)->Range(64, 16384);
@@ -0,0 +1,107 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "../../src/common/Optional.h"
+#include "AllocationCounter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+/**
+ * Checks that value_or_eval and value_or_throw take capturing lambdas without
+ * allocating, whether the optional holds a value or not. Unlike the
+ * microbenchmarks it does not need Google Benchmark and exits with an error
+ * when any of the paths allocated.
+ */
+
+namespace {
+struct Vector3Value {
+  float x, y, z;
+};
+
+/// Bigger than the small buffer of any std::function implementation.
+struct Fallback {
+  Vector3Value base;
+  Vector3Value offset;
+  float scale;
+  float padding[8];
+};
+
+/// Thrown without allocating, std::runtime_error copies its message.
+struct MissingValue : std::exception {
+  const char *what() const noexcept override { return "Missing value"; }
+};
+
+volatile float sSink;
+
+bool Check(const char *name, std::size_t allocations) {
+  std::printf("%-40s %s\n", name, allocations == 0 ? "ok" : "ALLOCATED");
+  return allocations == 0;
+}
+
+std::size_t ValueOrEval(const Optional<Vector3Value> &value) {
+  const Fallback fallback{{1.0f, 2.0f, 3.0f}, {0.5f, 0.5f, 0.5f}, 2.0f, {}};
+  AllocationCounter allocations;
+  sSink = value
+              .value_or_eval([fallback] {
+                return Vector3Value{
+                    fallback.base.x + fallback.offset.x * fallback.scale,
+                    fallback.base.y, fallback.base.z};
+              })
+              .x;
+  return allocations.GetCount();
+}
+
+std::size_t ValueOrThrow(const Optional<Vector3Value> &value) {
+  const Fallback fallback{{1.0f, 2.0f, 3.0f}, {0.5f, 0.5f, 0.5f}, 2.0f, {}};
+  const std::string context(64, 'x');
+  AllocationCounter allocations;
+  try {
+    sSink = value
+                .value_or_throw([fallback, &context] {
+                  sSink = fallback.scale + context.size();
+                  return MissingValue();
+                })
+                .x;
+  } catch (const MissingValue &) {
+    // NOTE: The exception object itself comes from the C++ runtime, not from
+    // operator new, so it is not counted
+  }
+  return allocations.GetCount();
+}
+} // namespace
+
+int main() {
+  Optional<Vector3Value> present;
+  present.emplace(Vector3Value{1.0f, 2.0f, 3.0f});
+  const Optional<Vector3Value> empty;
+
+  bool isClean = true;
+  isClean &= Check("value_or_eval, present", ValueOrEval(present));
+  isClean &= Check("value_or_eval, empty", ValueOrEval(empty));
+  isClean &= Check("value_or_throw, present", ValueOrThrow(present));
+  isClean &= Check("value_or_throw, empty", ValueOrThrow(empty));
+  return isClean ? EXIT_SUCCESS : EXIT_FAILURE;
+}
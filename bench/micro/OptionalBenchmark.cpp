@@ -0,0 +1,237 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "../../src/common/Optional.h"
+#include "AllocationCounter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+/// Same layout as the Position/Velocity components.
+struct Vector3Value {
+  float x, y, z;
+};
+
+/// Stands in for components carrying a name or resource path.
+struct NamedValue {
+  std::string name;
+  float weight;
+};
+
+Vector3Value MakeValue(Vector3Value *, int i) {
+  return Vector3Value{static_cast<float>(i), 1.0f, 2.0f};
+}
+
+NamedValue MakeValue(NamedValue *, int i) {
+  return NamedValue{"Models/Box_" + std::to_string(i) + ".mdl",
+                    static_cast<float>(i)};
+}
+
+template <typename T> std::vector<Optional<T>> MakeOptionals(int count) {
+  std::vector<Optional<T>> values;
+  values.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    if (i % 4 == 0) {
+      values.emplace_back();
+    } else {
+      values.emplace_back(MakeValue(static_cast<T *>(nullptr), i));
+    }
+  }
+  return values;
+}
+
+template <typename T> std::vector<std::optional<T>> MakeStdOptionals(int count) {
+  std::vector<std::optional<T>> values;
+  values.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    if (i % 4 == 0) {
+      values.emplace_back();
+    } else {
+      values.emplace_back(MakeValue(static_cast<T *>(nullptr), i));
+    }
+  }
+  return values;
+}
+
+template <typename T> void BM_OptionalCopy(benchmark::State &state) {
+  const auto source = MakeOptionals<T>(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<Optional<T>> copy(source);
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T> void BM_StdOptionalCopy(benchmark::State &state) {
+  const auto source = MakeStdOptionals<T>(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<std::optional<T>> copy(source);
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T> void BM_OptionalMove(benchmark::State &state) {
+  auto source = MakeOptionals<T>(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<Optional<T>> moved(std::make_move_iterator(source.begin()),
+                                   std::make_move_iterator(source.end()));
+    benchmark::DoNotOptimize(moved.data());
+    source.swap(moved);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T> void BM_StdOptionalMove(benchmark::State &state) {
+  auto source = MakeStdOptionals<T>(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    std::vector<std::optional<T>> moved(std::make_move_iterator(source.begin()),
+                                        std::make_move_iterator(source.end()));
+    benchmark::DoNotOptimize(moved.data());
+    source.swap(moved);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_OptionalValueOr(benchmark::State &state) {
+  const auto values =
+      MakeOptionals<Vector3Value>(static_cast<int>(state.range(0)));
+  const Vector3Value fallback{0.0f, 0.0f, 0.0f};
+  for (auto _ : state) {
+    float sum = 0.0f;
+    for (const auto &value : values) {
+      sum += value.value_or(fallback).x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_StdOptionalValueOr(benchmark::State &state) {
+  const auto values =
+      MakeStdOptionals<Vector3Value>(static_cast<int>(state.range(0)));
+  const Vector3Value fallback{0.0f, 0.0f, 0.0f};
+  for (auto _ : state) {
+    float sum = 0.0f;
+    for (const auto &value : values) {
+      sum += value.value_or(fallback).x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+/// Captures more than std::function can store without allocating.
+struct Fallback {
+  Vector3Value base;
+  Vector3Value offset;
+  float scale;
+
+  Vector3Value operator()() const {
+    return Vector3Value{base.x + offset.x * scale, base.y + offset.y * scale,
+                        base.z + offset.z * scale};
+  }
+};
+
+void BM_OptionalValueOrEval(benchmark::State &state) {
+  const auto values =
+      MakeOptionals<Vector3Value>(static_cast<int>(state.range(0)));
+  const Fallback fallback{{1.0f, 2.0f, 3.0f}, {0.5f, 0.5f, 0.5f}, 2.0f};
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    float sum = 0.0f;
+    for (const auto &value : values) {
+      sum += value.value_or_eval([fallback] { return fallback(); }).x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  if (allocations.GetCount() != 0) {
+    state.SkipWithError("value_or_eval allocated");
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// What the std::function based value_or_eval cost per call.
+void BM_StdFunctionValueOrEval(benchmark::State &state) {
+  const auto values =
+      MakeOptionals<Vector3Value>(static_cast<int>(state.range(0)));
+  const Fallback fallback{{1.0f, 2.0f, 3.0f}, {0.5f, 0.5f, 0.5f}, 2.0f};
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    float sum = 0.0f;
+    for (const auto &value : values) {
+      const std::function<Vector3Value()> retriever = [fallback] {
+        return fallback();
+      };
+      sum += value ? value.value().x : retriever().x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(allocations.GetCount()),
+      benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_OptionalValueOrThrow(benchmark::State &state) {
+  auto values = MakeOptionals<NamedValue>(static_cast<int>(state.range(0)));
+  for (auto &value : values) {
+    if (!value) {
+      value.emplace(NamedValue{"Models/Box.mdl", 0.0f});
+    }
+  }
+  const std::string context(64, 'x');
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    float sum = 0.0f;
+    for (const auto &value : values) {
+      sum += value
+                 .value_or_throw(
+                     [&context] { return std::runtime_error(context); })
+                 .weight;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  if (allocations.GetCount() != 0) {
+    state.SkipWithError("value_or_throw allocated");
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_OptionalCopy, Vector3Value)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_StdOptionalCopy, Vector3Value)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_OptionalCopy, NamedValue)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_StdOptionalCopy, NamedValue)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_OptionalMove, NamedValue)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_StdOptionalMove, NamedValue)->Range(64, 16384);
+BENCHMARK(BM_OptionalValueOr)->Range(64, 16384);
+BENCHMARK(BM_StdOptionalValueOr)->Range(64, 16384);
+BENCHMARK(BM_OptionalValueOrEval)->Range(64, 16384);
+BENCHMARK(BM_StdFunctionValueOrEval)->Range(64, 16384);
+BENCHMARK(BM_OptionalValueOrThrow)->Range(64, 16384);
@@ -0,0 +1,217 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "../../src/common/RingBuffer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr std::size_t RING_CAPACITY = 4096;
+constexpr std::uint64_t ITEMS_PER_PRODUCER = 1 << 18;
+
+std::uint64_t MakeItem(std::uint64_t producer, std::uint64_t sequence) {
+  return (producer << 40) | sequence;
+}
+
+/**
+ * Checks that every producer's items arrive exactly once and in the order
+ * they were pushed, which is all either ring promises.
+ */
+class OrderChecker {
+public:
+  explicit OrderChecker(std::size_t producers) : mNext(producers, 0) {}
+
+  bool Check(std::uint64_t item) {
+    auto producer = item >> 40;
+    auto sequence = item & ((std::uint64_t(1) << 40) - 1);
+    if (producer >= mNext.size() || mNext[producer] != sequence) {
+      return false;
+    }
+    ++mNext[producer];
+    return true;
+  }
+
+private:
+  std::vector<std::uint64_t> mNext;
+};
+
+void BM_SpscRing(benchmark::State &state) {
+  const auto batch = static_cast<std::size_t>(state.range(0));
+  auto ring = std::make_unique<SpscRing<std::uint64_t, RING_CAPACITY>>();
+  bool ordered = true;
+  for (auto _ : state) {
+    std::thread producer([&ring, batch] {
+      std::vector<std::uint64_t> items(batch);
+      for (std::uint64_t sent = 0; sent < ITEMS_PER_PRODUCER;) {
+        auto count = std::min<std::uint64_t>(batch, ITEMS_PER_PRODUCER - sent);
+        for (std::uint64_t i = 0; i < count; ++i) {
+          items[i] = MakeItem(0, sent + i);
+        }
+        std::size_t pushed = 0;
+        while (pushed < count) {
+          auto added =
+              ring->PushBatch(items.begin() + pushed, count - pushed);
+          if (added == 0) {
+            std::this_thread::yield();
+          }
+          pushed += added;
+        }
+        sent += count;
+      }
+    });
+    OrderChecker checker(1);
+    std::vector<std::uint64_t> items(batch);
+    for (std::uint64_t received = 0; received < ITEMS_PER_PRODUCER;) {
+      auto popped = ring->PopBatch(items.begin(), batch);
+      if (popped == 0) {
+        std::this_thread::yield();
+      }
+      for (std::size_t i = 0; i < popped; ++i) {
+        ordered = checker.Check(items[i]) && ordered;
+      }
+      received += popped;
+    }
+    producer.join();
+  }
+  if (!ordered) {
+    state.SkipWithError("SpscRing delivered items out of order");
+  }
+  state.SetItemsProcessed(state.iterations() * ITEMS_PER_PRODUCER);
+}
+
+template <typename Queue, typename PushFn, typename PopFn>
+bool RunMultiProducer(Queue &queue, std::size_t producers, std::size_t batch,
+                      PushFn push, PopFn pop) {
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&queue, p, batch, push] {
+      std::vector<std::uint64_t> items(batch);
+      for (std::uint64_t sent = 0; sent < ITEMS_PER_PRODUCER;) {
+        auto count = std::min<std::uint64_t>(batch, ITEMS_PER_PRODUCER - sent);
+        for (std::uint64_t i = 0; i < count; ++i) {
+          items[i] = MakeItem(p, sent + i);
+        }
+        while (!push(queue, items.data(), count)) {
+          std::this_thread::yield();
+        }
+        sent += count;
+      }
+    });
+  }
+  OrderChecker checker(producers);
+  bool ordered = true;
+  std::vector<std::uint64_t> items(256);
+  for (std::uint64_t received = 0; received < producers * ITEMS_PER_PRODUCER;) {
+    auto popped = pop(queue, items.data(), items.size());
+    if (popped == 0) {
+      std::this_thread::yield();
+    }
+    for (std::size_t i = 0; i < popped; ++i) {
+      ordered = checker.Check(items[i]) && ordered;
+    }
+    received += popped;
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return ordered;
+}
+
+void BM_MpscRing(benchmark::State &state) {
+  using Ring = MpscRing<std::uint64_t, RING_CAPACITY>;
+  const auto producers = static_cast<std::size_t>(state.range(0));
+  const auto batch = static_cast<std::size_t>(state.range(1));
+  auto ring = std::make_unique<Ring>();
+  bool ordered = true;
+  for (auto _ : state) {
+    ordered = RunMultiProducer(
+                  *ring, producers, batch,
+                  [](Ring &queue, std::uint64_t *items, std::size_t count) {
+                    return queue.PushBatch(items, count) == count;
+                  },
+                  [](Ring &queue, std::uint64_t *items, std::size_t count) {
+                    return queue.PopBatch(items, count);
+                  }) &&
+              ordered;
+  }
+  if (!ordered) {
+    state.SkipWithError("MpscRing lost or reordered items");
+  }
+  state.SetItemsProcessed(state.iterations() * producers * ITEMS_PER_PRODUCER);
+}
+
+/// Baseline: what a mutex protected deque does with the same traffic.
+struct LockedQueue {
+  std::mutex mutex;
+  std::deque<std::uint64_t> items;
+};
+
+void BM_MutexDeque(benchmark::State &state) {
+  const auto producers = static_cast<std::size_t>(state.range(0));
+  const auto batch = static_cast<std::size_t>(state.range(1));
+  LockedQueue queue;
+  bool ordered = true;
+  for (auto _ : state) {
+    ordered =
+        RunMultiProducer(
+            queue, producers, batch,
+            [](LockedQueue &queue, std::uint64_t *items, std::size_t count) {
+              std::lock_guard<std::mutex> lock(queue.mutex);
+              if (queue.items.size() + count > RING_CAPACITY) {
+                return false;
+              }
+              queue.items.insert(queue.items.end(), items, items + count);
+              return true;
+            },
+            [](LockedQueue &queue, std::uint64_t *items, std::size_t count) {
+              std::lock_guard<std::mutex> lock(queue.mutex);
+              std::size_t popped = 0;
+              while (popped < count && !queue.items.empty()) {
+                items[popped++] = queue.items.front();
+                queue.items.pop_front();
+              }
+              return popped;
+            }) &&
+        ordered;
+  }
+  if (!ordered) {
+    state.SkipWithError("Mutex deque lost or reordered items");
+  }
+  state.SetItemsProcessed(state.iterations() * producers * ITEMS_PER_PRODUCER);
+}
+} // namespace
+
+BENCHMARK(BM_SpscRing)->Arg(1)->Arg(64)->UseRealTime();
+BENCHMARK(BM_MpscRing)
+    ->ArgsProduct({{1, 2, 4}, {1, 64}})
+    ->UseRealTime();
+BENCHMARK(BM_MutexDeque)
+    ->ArgsProduct({{1, 2, 4}, {1, 64}})
+    ->UseRealTime();
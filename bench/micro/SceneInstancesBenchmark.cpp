@@ -0,0 +1,137 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "../../src/components/Direction.h"
+#include "../../src/components/Position.h"
+#include "../../src/components/Renderable.h"
+#include "../../src/components/Scale.h"
+#include "../../src/systems/providers/scene/NodeInstances.h"
+#include "BridgeWorld.h"
+
+#include <benchmark/benchmark.h>
+
+/*
+ * NodeInstances stands in for every provider here: the lookups are shared by
+ * all of them through SceneInstances and nodes are the cheapest instances to
+ * create in a headless context.
+ */
+
+namespace {
+/// Entities with a node. `density` percent of them are renderable at all.
+void PopulateRenderables(BridgeWorld &world, const benchmark::State &state) {
+  world.Populate(static_cast<int>(state.range(0)),
+                 static_cast<int>(state.range(1)),
+                 [](entityx::Entity entity, int) {
+                   entity.assign<Renderable>();
+                 });
+}
+
+/// Renderable entities, `density` percent of them with a transform to sync.
+void PopulateTransforms(BridgeWorld &world, const benchmark::State &state) {
+  world.Populate(
+      static_cast<int>(state.range(0)), static_cast<int>(state.range(1)),
+      [](entityx::Entity entity, int i) {
+        entity.assign<Renderable>();
+        entity.assign<Position>(static_cast<float>(i), 0.0f, 0.0f);
+        entity.assign<Direction>()->Yaw(static_cast<float>(i));
+        entity.assign<Scale>(2, 2, 2);
+      },
+      [](entityx::Entity entity, int) { entity.assign<Renderable>(); });
+}
+
+/// Creates the nodes up front, these benchmarks measure the steady state.
+void CreateNodes(BridgeWorld &world, NodeInstances &nodes) {
+  for (auto entity : world.GetEntities()) {
+    nodes.Sync(entity, world.entities);
+  }
+}
+
+void BM_SceneInstancesGetIfExists(benchmark::State &state) {
+  BridgeWorld world;
+  NodeInstances nodes(world.GetScene());
+  PopulateRenderables(world, state);
+  CreateNodes(world, nodes);
+  for (auto _ : state) {
+    unsigned found = 0;
+    for (auto entity : world.GetEntities()) {
+      found += nodes.GetIfExists(entity) ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_SceneInstancesGet(benchmark::State &state) {
+  BridgeWorld world;
+  NodeInstances nodes(world.GetScene());
+  PopulateRenderables(world, state);
+  CreateNodes(world, nodes);
+  Urho3D::SharedPtr<Urho3D::Node> node;
+  for (auto _ : state) {
+    unsigned found = 0;
+    for (auto entity : world.GetEntities()) {
+      found += nodes.Get(node, entity, world.entities) ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Get followed by SyncFromData; subtract BM_SceneInstancesGet at full
+/// density for the cost of pushing the transforms into the nodes.
+void BM_NodeInstancesSync(benchmark::State &state) {
+  BridgeWorld world;
+  NodeInstances nodes(world.GetScene());
+  PopulateTransforms(world, state);
+  CreateNodes(world, nodes);
+  for (auto _ : state) {
+    for (auto entity : world.GetEntities()) {
+      nodes.Sync(entity, world.entities);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// The first Sync of every entity, which creates its node.
+void BM_NodeInstancesCreate(benchmark::State &state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      BridgeWorld world;
+      NodeInstances nodes(world.GetScene());
+      PopulateRenderables(world, state);
+      state.ResumeTiming();
+      CreateNodes(world, nodes);
+      state.PauseTiming();
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+BENCHMARK(BM_SceneInstancesGetIfExists)->Apply(EntityCountsAndDensities);
+BENCHMARK(BM_SceneInstancesGet)->Apply(EntityCountsAndDensities);
+BENCHMARK(BM_NodeInstancesSync)->Apply(EntityCountsAndDensities);
+BENCHMARK(BM_NodeInstancesCreate)->Apply(EntityCountsAndDensities);
@@ -0,0 +1,105 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+
+#include "../../src/components/Name.h"
+#include "../../src/components/Position.h"
+#include "../../src/components/Renderable.h"
+#include "../../src/components/Scale.h"
+#include "../../src/components/StaticModel.h"
+#include "../../src/components/Tags.h"
+#include "../../src/state/WorldSnapshot.h"
+#include "BridgeWorld.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+constexpr const char *SNAPSHOT_FILE = "bench-world.snapshot";
+
+/// The grid boxes of the demo, the bulk of what a snapshot holds.
+void PopulateBoxes(BridgeWorld &world, int count) {
+  auto &tags = world.GetTags();
+  world.Populate(count, 100, [&tags](entityx::Entity entity, int i) {
+    entity.assign<Renderable>();
+    entity.assign<Name>("Box");
+    entity.assign<Position>(static_cast<float>(i % 1000), -3.0f,
+                            static_cast<float>(i / 1000));
+    entity.assign<Scale>(2.0f, 2.0f, 2.0f);
+    entity.assign<StaticModel>("Models/Box.mdl", "Materials/Stone.xml");
+    tags.Set<Static>(entity);
+  });
+}
+
+void BM_SnapshotSave(benchmark::State &state) {
+  BridgeWorld world;
+  PopulateBoxes(world, static_cast<int>(state.range(0)));
+  WorldSnapshot snapshot(world.entities, world.GetTags());
+  for (auto _ : state) {
+    if (!snapshot.Save(SNAPSHOT_FILE)) {
+      state.SkipWithError("Could not save the snapshot");
+      break;
+    }
+  }
+  std::remove(SNAPSHOT_FILE);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Loads into a world emptied between iterations, so the entity indices and
+/// component pools are reused the way a level reload would.
+void BM_SnapshotLoad(benchmark::State &state) {
+  BridgeWorld world;
+  PopulateBoxes(world, static_cast<int>(state.range(0)));
+  WorldSnapshot snapshot(world.entities, world.GetTags());
+  if (!snapshot.Save(SNAPSHOT_FILE)) {
+    state.SkipWithError("Could not save the snapshot");
+    return;
+  }
+  std::vector<entityx::Entity> loaded;
+  for (auto _ : state) {
+    state.PauseTiming();
+    world.entities.reset();
+    loaded.clear();
+    state.ResumeTiming();
+    if (!snapshot.Load(SNAPSHOT_FILE, loaded)) {
+      state.SkipWithError("Could not load the snapshot");
+      break;
+    }
+  }
+  std::remove(SNAPSHOT_FILE);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+BENCHMARK(BM_SnapshotSave)
+    ->Arg(1024)
+    ->Arg(65536)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SnapshotLoad)
+    ->Arg(1024)
+    ->Arg(65536)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,124 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "../../src/common/Storage.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+/// Same layout as the Position/Velocity components.
+struct Vector3Value {
+  float x, y, z;
+};
+
+static_assert(std::is_trivially_copyable<Vector3Value>::value,
+              "Vector3Value should take the trivially copyable Storage");
+
+Vector3Value MakeValue(Vector3Value *, int i) {
+  return Vector3Value{static_cast<float>(i), 1.0f, 2.0f};
+}
+
+std::string MakeValue(std::string *, int i) {
+  return "Models/Box_" + std::to_string(i) + ".mdl";
+}
+
+/// Emplace, read back and destroy, the life of a value inside an Optional.
+template <typename T> void BM_StorageEmplace(benchmark::State &state) {
+  const auto count = static_cast<int>(state.range(0));
+  std::vector<T> values;
+  values.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    values.push_back(MakeValue(static_cast<T *>(nullptr), i));
+  }
+  std::vector<internal::Storage<T>> storages(count);
+  for (auto _ : state) {
+    for (int i = 0; i < count; ++i) {
+      storages[i].emplace(values[i]);
+    }
+    benchmark::DoNotOptimize(storages.data());
+    for (auto &storage : storages) {
+      storage.destroy();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template <typename T> void BM_StorageRead(benchmark::State &state) {
+  const auto count = static_cast<int>(state.range(0));
+  std::vector<internal::Storage<T>> storages(count);
+  for (int i = 0; i < count; ++i) {
+    storages[i].emplace(MakeValue(static_cast<T *>(nullptr), i));
+  }
+  for (auto _ : state) {
+    for (const auto &storage : storages) {
+      benchmark::DoNotOptimize(storage.ref());
+    }
+  }
+  for (auto &storage : storages) {
+    storage.destroy();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+/// Trivially copyable storage keeps its implicit copy, which should be as
+/// cheap as copying the values themselves.
+void BM_StorageCopyTrivial(benchmark::State &state) {
+  const auto count = static_cast<int>(state.range(0));
+  std::vector<internal::Storage<Vector3Value>> source(count);
+  for (int i = 0; i < count; ++i) {
+    source[i].emplace(MakeValue(static_cast<Vector3Value *>(nullptr), i));
+  }
+  std::vector<internal::Storage<Vector3Value>> copy(count);
+  for (auto _ : state) {
+    copy = source;
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+void BM_RawCopyTrivial(benchmark::State &state) {
+  const auto count = static_cast<int>(state.range(0));
+  std::vector<Vector3Value> source;
+  source.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    source.push_back(MakeValue(static_cast<Vector3Value *>(nullptr), i));
+  }
+  std::vector<Vector3Value> copy(count);
+  for (auto _ : state) {
+    copy = source;
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_StorageEmplace, Vector3Value)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_StorageEmplace, std::string)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_StorageRead, Vector3Value)->Range(64, 16384);
+BENCHMARK_TEMPLATE(BM_StorageRead, std::string)->Range(64, 16384);
+BENCHMARK(BM_StorageCopyTrivial)->Range(64, 16384);
+BENCHMARK(BM_RawCopyTrivial)->Range(64, 16384);
@@ -0,0 +1,191 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "Baseline.h"
+
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Resource/JSONValue.h>
+
+#include <algorithm>
+
+namespace {
+float GetFloat(const Urho3D::JSONValue &object, const char *key,
+               float fallback) {
+  const auto &value = object.Get(key);
+  return value.IsNumber() ? value.GetFloat() : fallback;
+}
+
+/// Whether `current` got worse than `baseline` by more than both the
+/// relative tolerance and the absolute slack.
+bool IsRegression(double baseline, double current, double tolerance,
+                  double slack) {
+  return current > baseline * (1.0 + tolerance) && current - baseline > slack;
+}
+
+/// Prints a row of the table and returns whether it regressed.
+bool CompareRow(std::FILE *out, const char *metric, double baseline,
+                double current, double tolerance, double slack) {
+  bool regressed = IsRegression(baseline, current, tolerance, slack);
+  if (baseline > 0.0) {
+    std::fprintf(out, "%-40.40s %12.3f %12.3f %+8.1f%% %s\n", metric, baseline,
+                 current, (current / baseline - 1.0) * 100.0,
+                 regressed ? "REGRESSED" : "");
+  } else {
+    std::fprintf(out, "%-40.40s %12.3f %12.3f %9s %s\n", metric, baseline,
+                 current, "", regressed ? "REGRESSED" : "");
+  }
+  return regressed;
+}
+} // namespace
+
+BaselineFile::BaselineFile(Urho3D::Context *context)
+    : mFile(new Urho3D::JSONFile(context)) {}
+
+bool BaselineFile::Load(const Urho3D::String &path) {
+  auto fileSystem = mFile->GetSubsystem<Urho3D::FileSystem>();
+  if (fileSystem && !fileSystem->FileExists(path)) {
+    return true;
+  }
+  return mFile->LoadFile(path);
+}
+
+bool BaselineFile::Save(const Urho3D::String &path) {
+  Urho3D::File file(mFile->GetContext(), path, Urho3D::FILE_WRITE);
+  return file.IsOpen() && mFile->Save(file, "  ");
+}
+
+RegressionTolerances BaselineFile::GetTolerances() const {
+  RegressionTolerances tolerances;
+  const auto &values = mFile->GetRoot().Get("tolerances");
+  tolerances.time = GetFloat(values, "time", tolerances.time);
+  tolerances.timeSlackMs =
+      GetFloat(values, "time_slack_ms", tolerances.timeSlackMs);
+  tolerances.allocations =
+      GetFloat(values, "allocations", tolerances.allocations);
+  tolerances.allocationSlack =
+      GetFloat(values, "allocation_slack", tolerances.allocationSlack);
+  tolerances.memory = GetFloat(values, "memory", tolerances.memory);
+  tolerances.memorySlackKiB = static_cast<unsigned>(GetFloat(
+      values, "memory_slack_kib", static_cast<float>(tolerances.memorySlackKiB)));
+  return tolerances;
+}
+
+bool BaselineFile::Get(const Urho3D::String &scenario,
+                       ScaleResults &out) const {
+  const auto &values = mFile->GetRoot().Get("scenarios").Get(scenario);
+  if (!values.IsObject()) {
+    return false;
+  }
+  const auto &frame = values.Get("frame_ms");
+  out.frameAvg = GetFloat(frame, "avg", 0.0f);
+  out.frameP50 = GetFloat(frame, "p50", 0.0f);
+  out.frameP99 = GetFloat(frame, "p99", 0.0f);
+  out.sections.clear();
+  const auto &sections = values.Get("sections_ms");
+  if (sections.IsObject()) {
+    for (auto itr = sections.Begin(); itr != sections.End(); ++itr) {
+      out.sections.emplace_back(itr->first_, itr->second_.GetFloat());
+    }
+  }
+  out.allocationsPerFrame = GetFloat(values, "allocations_per_frame", 0.0f);
+  out.peakResidentKiB =
+      static_cast<unsigned>(GetFloat(values, "peak_resident_kib", 0.0f));
+  return true;
+}
+
+void BaselineFile::Set(const Urho3D::String &scenario,
+                       const ScaleResults &results) {
+  Urho3D::JSONValue frame;
+  frame.Set("avg", results.frameAvg);
+  frame.Set("p50", results.frameP50);
+  frame.Set("p99", results.frameP99);
+  Urho3D::JSONValue sections;
+  for (const auto &section : results.sections) {
+    sections.Set(section.first, section.second);
+  }
+  Urho3D::JSONValue values;
+  values.Set("frame_ms", frame);
+  values.Set("sections_ms", sections);
+  values.Set("allocations_per_frame", results.allocationsPerFrame);
+  values.Set("peak_resident_kib", results.peakResidentKiB);
+
+  auto &root = mFile->GetRoot();
+  if (!root.IsObject()) {
+    root = Urho3D::JSONValue(Urho3D::JSON_OBJECT);
+  }
+  if (root.Get("tolerances").IsNull()) {
+    RegressionTolerances defaults;
+    Urho3D::JSONValue tolerances;
+    tolerances.Set("time", defaults.time);
+    tolerances.Set("time_slack_ms", defaults.timeSlackMs);
+    tolerances.Set("allocations", defaults.allocations);
+    tolerances.Set("allocation_slack", defaults.allocationSlack);
+    tolerances.Set("memory", defaults.memory);
+    tolerances.Set("memory_slack_kib", defaults.memorySlackKiB);
+    root.Set("tolerances", tolerances);
+  }
+  auto scenarios = root.Get("scenarios");
+  if (!scenarios.IsObject()) {
+    scenarios = Urho3D::JSONValue(Urho3D::JSON_OBJECT);
+  }
+  scenarios.Set(scenario, values);
+  root.Set("scenarios", scenarios);
+}
+
+bool CompareResults(const ScaleResults &baseline, const ScaleResults &current,
+                    const RegressionTolerances &tolerances, std::FILE *out) {
+  std::fprintf(out, "%-40s %12s %12s %9s\n", "Metric", "baseline", "current",
+               "change");
+  bool regressed = false;
+  const double time = tolerances.time;
+  const double timeSlack = tolerances.timeSlackMs;
+  regressed |= CompareRow(out, "Frame avg (ms)", baseline.frameAvg,
+                          current.frameAvg, time, timeSlack);
+  regressed |= CompareRow(out, "Frame p50 (ms)", baseline.frameP50,
+                          current.frameP50, time, timeSlack);
+  regressed |= CompareRow(out, "Frame p99 (ms)", baseline.frameP99,
+                          current.frameP99, time, timeSlack);
+  for (const auto &section : current.sections) {
+    auto itr = std::find_if(
+        baseline.sections.begin(), baseline.sections.end(),
+        [&section](const std::pair<Urho3D::String, float> &entry) {
+          return entry.first == section.first;
+        });
+    if (itr == baseline.sections.end()) {
+      std::fprintf(out, "%-40.40s %12s %12.3f %9s\n",
+                   section.first.CString(), "new", section.second, "");
+      continue;
+    }
+    regressed |= CompareRow(out, section.first.CString(), itr->second,
+                            section.second, time, timeSlack);
+  }
+  regressed |= CompareRow(out, "Allocations per frame",
+                          baseline.allocationsPerFrame,
+                          current.allocationsPerFrame, tolerances.allocations,
+                          tolerances.allocationSlack);
+  regressed |= CompareRow(out, "Peak resident (KiB)", baseline.peakResidentKiB,
+                          current.peakResidentKiB, tolerances.memory,
+                          tolerances.memorySlackKiB);
+  return !regressed;
+}
@@ -0,0 +1,106 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_BASELINE_H
+#define NINPOTEST_BASELINE_H
+
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Resource/JSONFile.h>
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+/// What one run of a scale benchmark scenario costs. Times in milliseconds.
+struct ScaleResults {
+  float frameAvg = 0.0f;
+  float frameP50 = 0.0f;
+  float frameP99 = 0.0f;
+  /// Average time per frame of every system and GameState phase.
+  std::vector<std::pair<Urho3D::String, float>> sections;
+  float allocationsPerFrame = 0.0f;
+  unsigned peakResidentKiB = 0;
+};
+
+/**
+ * How much worse than its baseline a run may get before it counts as a
+ * regression. Increases are relative, 0.1 being 10%, and have to exceed the
+ * absolute slack as well, which keeps sections taking next to no time from
+ * failing on noise.
+ */
+struct RegressionTolerances {
+  float time = 0.10f;
+  float timeSlackMs = 0.02f;
+  float allocations = 0.05f;
+  float allocationSlack = 0.5f;
+  float memory = 0.10f;
+  unsigned memorySlackKiB = 1024;
+};
+
+/**
+ * The checked in baselines of every scenario along with the tolerances to
+ * compare against them with:
+ *
+ *   {
+ *     "tolerances": {"time": 0.1, "time_slack_ms": 0.02, ...},
+ *     "scenarios": {
+ *       "small": {
+ *         "frame_ms": {"avg": 1.2, "p50": 1.1, "p99": 2.5},
+ *         "sections_ms": {"MovementSystem": 0.1, ...},
+ *         "allocations_per_frame": 3.0,
+ *         "peak_resident_kib": 81920
+ *       }
+ *     }
+ *   }
+ */
+class BaselineFile {
+public:
+  explicit BaselineFile(Urho3D::Context *context);
+
+  /// A missing file counts as one without any baselines.
+  bool Load(const Urho3D::String &path);
+
+  bool Save(const Urho3D::String &path);
+
+  RegressionTolerances GetTolerances() const;
+
+  /// Returns false when there is no baseline for the scenario.
+  bool Get(const Urho3D::String &scenario, ScaleResults &out) const;
+
+  void Set(const Urho3D::String &scenario, const ScaleResults &results);
+
+private:
+  Urho3D::SharedPtr<Urho3D::JSONFile> mFile;
+};
+
+/**
+ * Prints a table of the differences between a run and its baseline.
+ *
+ * @return false if anything regressed
+ */
+bool CompareResults(const ScaleResults &baseline, const ScaleResults &current,
+                    const RegressionTolerances &tolerances, std::FILE *out);
+
+#endif // NINPOTEST_BASELINE_H
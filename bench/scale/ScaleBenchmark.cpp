@@ -0,0 +1,508 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Math/MathDefs.h>
+#include <Urho3D/Math/Random.h>
+
+#include "../../src/common/FrameCounters.h"
+#include "../../src/components/AngularVelocity.h"
+#include "../../src/components/Camera.h"
+#include "../../src/components/Direction.h"
+#include "../../src/components/Light.h"
+#include "../../src/components/Position.h"
+#include "../../src/components/Scale.h"
+#include "../../src/components/Sound.h"
+#include "../../src/components/SoundListener.h"
+#include "../../src/components/StaticModel.h"
+#include "../../src/components/Velocity.h"
+#include "../../src/state/GameState.h"
+#include "../../src/systems/MovementSystem.h"
+#include "../../src/systems/UrhoSystem.h"
+#include "../micro/AllocationCounter.h"
+#include "Baseline.h"
+
+/**
+ * Measures how the bridge between entityx and Urho3D scales with the size of
+ * the scene. Boots the engine headless, so it runs on machines without a GPU
+ * or a sound card, builds a scene out of the game's own components and
+ * systems and runs it for a fixed number of frames with a fixed time step.
+ *
+ * Options:
+ *   -scenario S   one of the presets below, the options after it override it
+ *   -statics N    static models (1000)
+ *   -movers N     moving and spinning models (200)
+ *   -lights N     point lights (16)
+ *   -sounds N     looping 3D sounds (16)
+ *   -frames N     frames measured (600)
+ *   -output PATH  file the JSON report is written to, stdout by default
+ *   -trace PATH   also trace the measured frames and write them to PATH
+ *   -baseline PATH  compare the run against the scenario's baseline in PATH,
+ *                 exiting with an error if anything regressed
+ *   -update-baseline  store the run as the scenario's baseline instead
+ *   -require-baseline  also fail when PATH or the scenario's baseline in it
+ *                 is missing, instead of only reporting it
+ *   -tolerance F  relative slowdown allowed, overriding the baseline file's
+ *
+ * Scenarios: "small" (the defaults), "medium" and "large". Any other name
+ * is an error.
+ *
+ * The report holds the options, percentiles of the frame time and the time
+ * spent per frame in every system and GameState phase, all in milliseconds,
+ * along with the allocations per frame, the peak resident memory and the
+ * hot path counters (see FrameCounters). The comparison against a baseline
+ * is printed to stderr.
+ */
+
+namespace {
+/// Simulated time per frame.
+constexpr float TIME_STEP = 1.0f / 60.0f;
+/// Frames run before measuring, to get resources loaded and instances made.
+constexpr unsigned WARMUP_FRAMES = 60;
+/// Edge length of the square the scene is spread over.
+constexpr float SCENE_SIZE = 200.0f;
+/// Measured frames between samples of the resident memory.
+constexpr unsigned MEMORY_SAMPLE_FRAMES = 30;
+
+struct ScaleBenchSettings {
+  Urho3D::String scenario = "small";
+  unsigned statics = 1000;
+  unsigned movers = 200;
+  unsigned lights = 16;
+  unsigned sounds = 16;
+  unsigned frames = 600;
+  Urho3D::String output;
+  Urho3D::String trace;
+  Urho3D::String baseline;
+  bool updateBaseline = false;
+  bool requireBaseline = false;
+  /// Negative to use the baseline file's tolerance.
+  float tolerance = -1.0f;
+  /// Why the arguments could not be used, empty if they can.
+  Urho3D::String error;
+};
+
+bool ApplyScenario(ScaleBenchSettings &settings,
+                   const Urho3D::String &scenario) {
+  if (scenario == "small") {
+    settings.statics = 1000;
+    settings.movers = 200;
+    settings.lights = 16;
+    settings.sounds = 16;
+  } else if (scenario == "medium") {
+    settings.statics = 5000;
+    settings.movers = 1000;
+    settings.lights = 32;
+    settings.sounds = 32;
+  } else if (scenario == "large") {
+    settings.statics = 20000;
+    settings.movers = 4000;
+    settings.lights = 64;
+    settings.sounds = 64;
+  } else {
+    return false;
+  }
+  settings.scenario = scenario;
+  return true;
+}
+
+ScaleBenchSettings ParseSettings() {
+  ScaleBenchSettings settings;
+  const auto &arguments = Urho3D::GetArguments();
+  for (unsigned i = 0; i < arguments.Size(); ++i) {
+    const auto &argument = arguments[i];
+    if (argument == "-update-baseline") {
+      settings.updateBaseline = true;
+      continue;
+    }
+    if (argument == "-require-baseline") {
+      settings.requireBaseline = true;
+      continue;
+    }
+    if (i + 1 == arguments.Size()) {
+      break;
+    }
+    if (argument == "-scenario") {
+      if (!ApplyScenario(settings, arguments[++i])) {
+        settings.error = "Unknown scenario '" + arguments[i] +
+                         "', expected small, medium or large";
+      }
+    } else if (argument == "-statics") {
+      settings.statics = Urho3D::ToUInt(arguments[++i]);
+    } else if (argument == "-movers") {
+      settings.movers = Urho3D::ToUInt(arguments[++i]);
+    } else if (argument == "-lights") {
+      settings.lights = Urho3D::ToUInt(arguments[++i]);
+    } else if (argument == "-sounds") {
+      settings.sounds = Urho3D::ToUInt(arguments[++i]);
+    } else if (argument == "-frames") {
+      settings.frames = Urho3D::Max(1u, Urho3D::ToUInt(arguments[++i]));
+    } else if (argument == "-output") {
+      settings.output = arguments[++i];
+    } else if (argument == "-trace") {
+      settings.trace = arguments[++i];
+    } else if (argument == "-baseline") {
+      settings.baseline = arguments[++i];
+    } else if (argument == "-tolerance") {
+      settings.tolerance = Urho3D::ToFloat(arguments[++i]);
+    }
+  }
+  return settings;
+}
+
+Urho3D::Vector3 RandomPosition(float height) {
+  return Urho3D::Vector3(Urho3D::Random(-0.5f, 0.5f) * SCENE_SIZE, height,
+                         Urho3D::Random(-0.5f, 0.5f) * SCENE_SIZE);
+}
+
+/// Value at the given percentile of sorted values, using the nearest rank.
+float Percentile(const std::vector<float> &sorted, unsigned percentile) {
+  auto rank = (sorted.size() * percentile + 99) / 100;
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/// Writes `text` as a JSON string. Section names are plain identifiers, only
+/// quotes and backslashes need escaping.
+void WriteJsonString(std::FILE *file, const char *text) {
+  std::fputc('"', file);
+  for (; *text; ++text) {
+    if (*text == '"' || *text == '\\') {
+      std::fputc('\\', file);
+    }
+    std::fputc(*text, file);
+  }
+  std::fputc('"', file);
+}
+} // namespace
+
+class ScaleBenchState : public GameState {
+  GAME_STATE(ScaleBenchState)
+public:
+  ScaleBenchState(Urho3D::Context *context, const ScaleBenchSettings &settings)
+      : GameState(context), mSettings(settings), mFrame(0),
+        mAllocationCount(0), mPeakResident(0) {
+    AddSystem<MovementSystem>("MovementSystem", mTags);
+    AddSystem<UrhoSystem>("UrhoSystem", context, mScene, mTags);
+    systems.configure();
+
+    const std::size_t expectedEntities =
+        settings.statics + settings.movers + settings.lights + settings.sounds +
+        16;
+    ReserveComponents<Renderable>(expectedEntities);
+    ReserveComponents<Name>(expectedEntities);
+    ReserveComponents<Position>(expectedEntities);
+    ReserveComponents<Scale>(expectedEntities);
+    ReserveComponents<StaticModel>(expectedEntities);
+    mFrameTimes.reserve(settings.frames);
+
+    mSoundBank->Load({"Sounds/Powerup.wav"});
+    auto loop = mSoundBank->Find("Sounds/Powerup.wav");
+
+    mScene->CreateComponent<Urho3D::Octree>();
+    // Same results on every run
+    Urho3D::SetRandomSeed(1);
+
+    auto camera = CreateRenderableEntity("Camera");
+    camera.assign<Camera>()->farClip = 2000.0f;
+    camera.assign<Position>(0.0f, 10.0f, 0.0f);
+    camera.assign<Direction>();
+    camera.assign<SoundListener>(camera.id());
+
+    for (unsigned i = 0; i < settings.statics; ++i) {
+      auto entity = CreateRenderableEntity("Static");
+      entity.assign<Position>(RandomPosition(0.0f));
+      entity.assign<Scale>(2, 2, 2);
+      entity.assign<StaticModel>("Models/Box.mdl", "Materials/Stone.xml");
+      mTags.Set<Static>(entity);
+    }
+    for (unsigned i = 0; i < settings.movers; ++i) {
+      auto entity = CreateRenderableEntity("Mover");
+      entity.assign<Position>(RandomPosition(5.0f));
+      entity.assign<Direction>();
+      entity.assign<StaticModel>("Models/Box.mdl", "Materials/Stone.xml");
+      entity.assign<Velocity>()->value = RandomPosition(0.0f) * 0.05f;
+      entity.assign<AngularVelocity>(Urho3D::Random(90.0f),
+                                     Urho3D::Random(90.0f), 0.0f);
+    }
+    for (unsigned i = 0; i < settings.lights; ++i) {
+      auto entity = CreateRenderableEntity("Light");
+      entity.assign<Position>(RandomPosition(8.0f));
+      auto light = Light{};
+      light.type = Urho3D::LIGHT_POINT;
+      light.range = 25;
+      entity.assign_from_copy(light);
+    }
+    for (unsigned i = 0; i < settings.sounds; ++i) {
+      auto entity = CreateRenderableEntity("Sound");
+      entity.assign<Position>(RandomPosition(1.0f));
+      auto sound = ::Sound(loop);
+      sound.isLooped = true;
+      entity.assign_from_copy(sound);
+    }
+
+    SubscribeToAllEvents();
+  }
+
+  /**
+   * Writes the JSON report and checks the run against its baseline, if asked
+   * to. Returns false when something could not be written or the run
+   * regressed.
+   */
+  bool Report() {
+    std::sort(mFrameTimes.begin(), mFrameTimes.end());
+    std::vector<ProfileStats> sections;
+    mProfiler->GetStats(sections);
+    auto results = GetResults(sections);
+    return WriteReport(results, sections) && CheckBaseline(results);
+  }
+
+protected:
+  void OnBeginFrame(BeginFrameData &data) override { mFrameTimer.Reset(); }
+
+  void OnEndFrame() override {
+    if (mFrame >= WARMUP_FRAMES) {
+      mFrameTimes.push_back(mFrameTimer.GetUSec(false) / 1000.0f);
+      if ((mFrame - WARMUP_FRAMES) % MEMORY_SAMPLE_FRAMES == 0) {
+        SampleResidentMemory();
+      }
+    }
+    ++mFrame;
+    auto engine = GetSubsystem<Urho3D::Engine>();
+    if (mFrame == WARMUP_FRAMES) {
+      mProfiler->Reset();
+      FrameCounters::Reset();
+      mAllocations = AllocationCounter();
+      FrameTracer::SetEnabled(!mSettings.trace.Empty());
+    } else if (mFrame == WARMUP_FRAMES + mSettings.frames) {
+      mAllocationCount = mAllocations.GetCount();
+      SampleResidentMemory();
+      if (FrameTracer::IsEnabled()) {
+        FrameTracer::SetEnabled(false);
+        if (!FrameTracer::Dump(mSettings.trace, mSettings.frames)) {
+          URHO3D_LOGERRORF("Could not write the trace to '%s'",
+                           mSettings.trace.CString());
+        }
+      }
+      engine->Exit();
+      return;
+    }
+    engine->SetNextTimeStep(TIME_STEP);
+  }
+
+private:
+  void SampleResidentMemory() {
+    mPeakResident =
+        std::max(mPeakResident, MemoryMonitor::GetResidentBytes());
+  }
+
+  /// Expects the frame times to be sorted.
+  ScaleResults GetResults(const std::vector<ProfileStats> &sections) const {
+    ScaleResults results;
+    if (!mFrameTimes.empty()) {
+      float total = 0.0f;
+      for (auto time : mFrameTimes) {
+        total += time;
+      }
+      results.frameAvg = total / mFrameTimes.size();
+      results.frameP50 = Percentile(mFrameTimes, 50);
+      results.frameP99 = Percentile(mFrameTimes, 99);
+    }
+    for (const auto &stats : sections) {
+      if (stats.totalSamples != 0) {
+        results.sections.emplace_back(
+            stats.name, static_cast<float>(stats.total / stats.totalSamples));
+      }
+    }
+    results.allocationsPerFrame =
+        static_cast<float>(mAllocationCount) / mSettings.frames;
+    results.peakResidentKiB = static_cast<unsigned>(mPeakResident / 1024);
+    return results;
+  }
+
+  bool WriteReport(const ScaleResults &results,
+                   const std::vector<ProfileStats> &sections) const {
+    auto file = mSettings.output.Empty()
+                    ? stdout
+                    : std::fopen(mSettings.output.CString(), "w");
+    if (!file) {
+      URHO3D_LOGERRORF("Could not open '%s' for the report",
+                       mSettings.output.CString());
+      return false;
+    }
+    std::fprintf(file, "{\n  \"scenario\": ");
+    WriteJsonString(file, mSettings.scenario.CString());
+    std::fprintf(file, ",\n  \"config\": {\"statics\": %u, \"movers\": %u, "
+                       "\"lights\": %u, \"sounds\": %u, \"frames\": %u},\n",
+                 mSettings.statics, mSettings.movers, mSettings.lights,
+                 mSettings.sounds, mSettings.frames);
+    if (!mFrameTimes.empty()) {
+      std::fprintf(file,
+                   "  \"frame_ms\": {\"min\": %.4f, \"avg\": %.4f, "
+                   "\"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, "
+                   "\"max\": %.4f},\n",
+                   mFrameTimes.front(), results.frameAvg, results.frameP50,
+                   Percentile(mFrameTimes, 90), results.frameP99,
+                   mFrameTimes.back());
+    }
+    std::fprintf(file,
+                 "  \"allocations_per_frame\": %.2f,\n"
+                 "  \"peak_resident_kib\": %u,\n",
+                 results.allocationsPerFrame, results.peakResidentKiB);
+
+    std::vector<FrameCounterStats> counters;
+    FrameCounters::GetStats(counters);
+    std::fprintf(file, "  \"counters\": [");
+    for (unsigned i = 0; i < counters.size(); ++i) {
+      std::fprintf(file, "%s\n    {\"name\": ", i == 0 ? "" : ",");
+      WriteJsonString(file, counters[i].name);
+      std::fprintf(file, ", \"per_frame\": %.2f, \"peak\": %llu}",
+                   counters[i].perFrame, counters[i].peak);
+    }
+    std::fprintf(file, "\n  ],\n");
+
+    std::fprintf(file, "  \"sections\": [");
+    bool first = true;
+    for (const auto &stats : sections) {
+      if (stats.totalSamples == 0) {
+        continue;
+      }
+      std::fprintf(file, "%s\n    {\"name\": ", first ? "" : ",");
+      WriteJsonString(file, stats.name);
+      // NOTE: min, max and p99 only cover the profiler's sliding window
+      std::fprintf(file,
+                   ", \"avg\": %.4f, \"frames\": %u, \"window_min\": %.4f, "
+                   "\"window_max\": %.4f, \"window_p99\": %.4f}",
+                   stats.total / stats.totalSamples, stats.totalSamples,
+                   stats.min, stats.max, stats.p99);
+      first = false;
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+    if (file != stdout) {
+      std::fclose(file);
+    }
+    return true;
+  }
+
+  bool CheckBaseline(const ScaleResults &results) {
+    if (mSettings.baseline.Empty()) {
+      return true;
+    }
+    if (mSettings.requireBaseline && !mSettings.updateBaseline &&
+        !GetSubsystem<Urho3D::FileSystem>()->FileExists(mSettings.baseline)) {
+      URHO3D_LOGERRORF("The baselines in '%s' do not exist",
+                       mSettings.baseline.CString());
+      return false;
+    }
+    BaselineFile baselines(context_);
+    if (!baselines.Load(mSettings.baseline)) {
+      URHO3D_LOGERRORF("Could not read the baselines in '%s'",
+                       mSettings.baseline.CString());
+      return false;
+    }
+    if (mSettings.updateBaseline) {
+      baselines.Set(mSettings.scenario, results);
+      if (!baselines.Save(mSettings.baseline)) {
+        URHO3D_LOGERRORF("Could not write the baselines to '%s'",
+                         mSettings.baseline.CString());
+        return false;
+      }
+      std::fprintf(stderr, "Stored the baseline of '%s'\n",
+                   mSettings.scenario.CString());
+      return true;
+    }
+    ScaleResults baseline;
+    if (!baselines.Get(mSettings.scenario, baseline)) {
+      // Not a regression unless asked for, there is nothing to compare against
+      std::fprintf(stderr,
+                   "No baseline for '%s' in '%s', store one with "
+                   "-update-baseline\n",
+                   mSettings.scenario.CString(), mSettings.baseline.CString());
+      return !mSettings.requireBaseline;
+    }
+    auto tolerances = baselines.GetTolerances();
+    if (mSettings.tolerance >= 0.0f) {
+      tolerances.time = mSettings.tolerance;
+    }
+    std::fprintf(stderr, "Scenario '%s'\n", mSettings.scenario.CString());
+    if (!CompareResults(baseline, results, tolerances, stderr)) {
+      std::fprintf(stderr, "'%s' regressed\n", mSettings.scenario.CString());
+      return false;
+    }
+    return true;
+  }
+
+  ScaleBenchSettings mSettings;
+  unsigned mFrame;
+  Urho3D::HiresTimer mFrameTimer;
+  std::vector<float> mFrameTimes;
+  AllocationCounter mAllocations;
+  std::size_t mAllocationCount;
+  std::size_t mPeakResident;
+};
+
+class ScaleBenchApp : public Urho3D::Application {
+public:
+  ScaleBenchApp(Urho3D::Context *context)
+      : Application(context), settings_(ParseSettings()) {}
+
+  virtual void Setup() {
+    if (!settings_.error.Empty()) {
+      ErrorExit(settings_.error);
+      return;
+    }
+    engineParameters_[Urho3D::EP_HEADLESS] = true;
+    engineParameters_[Urho3D::EP_SOUND] = false;
+    engineParameters_[Urho3D::EP_LOG_LEVEL] = Urho3D::LOG_WARNING;
+  }
+
+  virtual void Start() {
+    engine_->SetMaxFps(0);
+    state_ = new ScaleBenchState(context_, settings_);
+  }
+
+  virtual void Stop() {
+    if (state_ && !state_->Report()) {
+      exitCode_ = EXIT_FAILURE;
+    }
+    state_.Reset();
+  }
+
+private:
+  ScaleBenchSettings settings_;
+  Urho3D::SharedPtr<ScaleBenchState> state_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(ScaleBenchApp)
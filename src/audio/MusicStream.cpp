@@ -0,0 +1,173 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "MusicStream.h"
+#include "../common/GameLog.h"
+
+#include <STB/stb_vorbis.h>
+
+#include <algorithm>
+
+namespace {
+/// Bytes read from the file at a time.
+constexpr std::size_t INPUT_CHUNK = 8 * 1024;
+} // namespace
+
+MusicStream::MusicStream()
+    : mDecoder(nullptr), mInputStart(0), mPendingStart(0), mChannels(0),
+      mFrequency(0), mLooped(false), mAtEnd(true) {}
+
+MusicStream::~MusicStream() { CloseDecoder(); }
+
+bool MusicStream::Open(Urho3D::SharedPtr<Urho3D::File> file, bool looped) {
+  CloseDecoder();
+  mFile = file;
+  mLooped = looped;
+  mAtEnd = false;
+  if (!mFile || !OpenDecoder()) {
+    mAtEnd = true;
+    return false;
+  }
+  auto info = stb_vorbis_get_info(mDecoder);
+  if (info.channels < 1 || info.channels > 2) {
+    GAME_LOGERRORF("Music with %d channels is not supported", info.channels);
+    CloseDecoder();
+    mAtEnd = true;
+    return false;
+  }
+  mChannels = static_cast<unsigned>(info.channels);
+  mFrequency = info.sample_rate;
+  SetFormat(mFrequency, true, mChannels == 2);
+  return true;
+}
+
+void MusicStream::Fill(float seconds) {
+  auto target = std::min<std::size_t>(
+      RING_SAMPLES, static_cast<std::size_t>(seconds * mFrequency * mChannels));
+  while (mRing.Size() < target) {
+    if (mPendingStart < mPending.size()) {
+      auto pushed = mRing.PushBatch(mPending.begin() + mPendingStart,
+                                    mPending.size() - mPendingStart);
+      if (pushed == 0) {
+        break;
+      }
+      mPendingStart += pushed;
+    } else if (mAtEnd || !DecodeFrame()) {
+      mAtEnd = true;
+      break;
+    }
+  }
+}
+
+unsigned MusicStream::GetData(signed char *dest, unsigned numBytes) {
+  auto samples = mRing.PopBatch(reinterpret_cast<short *>(dest),
+                                numBytes / sizeof(short));
+  return static_cast<unsigned>(samples * sizeof(short));
+}
+
+bool MusicStream::OpenDecoder() {
+  mInput.clear();
+  mInputStart = 0;
+  mFile->Seek(0);
+  for (;;) {
+    int used = 0;
+    int error = 0;
+    mDecoder = stb_vorbis_open_pushdata(
+        mInput.data(), static_cast<int>(mInput.size()), &used, &error, nullptr);
+    if (mDecoder) {
+      mInputStart = static_cast<std::size_t>(used);
+      return true;
+    }
+    if (error != VORBIS_need_more_data || !ReadInput()) {
+      GAME_LOGERRORF("Could not decode Ogg Vorbis stream from '%s'",
+                     mFile->GetName().CString());
+      return false;
+    }
+  }
+}
+
+void MusicStream::CloseDecoder() {
+  if (mDecoder) {
+    stb_vorbis_close(mDecoder);
+    mDecoder = nullptr;
+  }
+  mPending.clear();
+  mPendingStart = 0;
+}
+
+bool MusicStream::DecodeFrame() {
+  auto rewound = false;
+  for (;;) {
+    int channels = 0;
+    int samples = 0;
+    float **output = nullptr;
+    int used = stb_vorbis_decode_frame_pushdata(
+        mDecoder, mInput.data() + mInputStart,
+        static_cast<int>(mInput.size() - mInputStart), &channels, &output,
+        &samples);
+    mInputStart += static_cast<std::size_t>(used);
+    if (samples > 0) {
+      mPending.resize(static_cast<std::size_t>(samples) * mChannels);
+      mPendingStart = 0;
+      for (int i = 0; i < samples; ++i) {
+        for (unsigned c = 0; c < mChannels; ++c) {
+          auto value = std::max(-1.0f, std::min(1.0f, output[c][i]));
+          mPending[i * mChannels + c] = static_cast<short>(value * 32767.0f);
+        }
+      }
+      return true;
+    }
+    if (used > 0) {
+      // Headers or a resync, no audio yet
+      continue;
+    }
+    if (ReadInput()) {
+      continue;
+    }
+    if (!mLooped || rewound) {
+      // A second rewind without any audio in between means there is none
+      return false;
+    }
+    // A new decoder is the simplest way back to the start, the headers have
+    // to be parsed again anyway
+    CloseDecoder();
+    if (!OpenDecoder()) {
+      return false;
+    }
+    rewound = true;
+  }
+}
+
+bool MusicStream::ReadInput() {
+  if (mFile->IsEof()) {
+    return false;
+  }
+  // Drop what the decoder already consumed before growing the buffer
+  mInput.erase(mInput.begin(), mInput.begin() + mInputStart);
+  mInputStart = 0;
+  auto size = mInput.size();
+  mInput.resize(size + INPUT_CHUNK);
+  auto read = mFile->Read(mInput.data() + size, INPUT_CHUNK);
+  mInput.resize(size + read);
+  return read > 0;
+}
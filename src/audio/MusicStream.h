@@ -0,0 +1,87 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_MUSICSTREAM_H
+#define NINPOTEST_MUSICSTREAM_H
+
+#include "../common/RingBuffer.h"
+
+#include <Urho3D/Audio/SoundStream.h>
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/IO/File.h>
+
+#include <vector>
+
+struct stb_vorbis;
+
+/**
+ * Ogg Vorbis file decoded a little at a time. The file is read in small
+ * chunks and `Fill`, called from the main thread, keeps a fraction of a second
+ * of samples queued in a lock-free ring that the audio thread drains. Memory
+ * use does not depend on the length of the track and playback can start as
+ * soon as the first frames are decoded.
+ */
+class MusicStream : public Urho3D::SoundStream {
+public:
+  /// Interleaved samples the ring holds, ~370 ms of 44.1 kHz stereo.
+  static constexpr std::size_t RING_SAMPLES = 1 << 15;
+
+  MusicStream();
+  ~MusicStream() override;
+
+  bool Open(Urho3D::SharedPtr<Urho3D::File> file, bool looped);
+
+  /// Decodes until about `seconds` of audio are queued.
+  void Fill(float seconds);
+
+  /// Whether the track ended and everything queued has been played.
+  bool IsFinished() const { return mAtEnd && mRing.Size() == 0; }
+
+  /// Called from the audio thread.
+  unsigned GetData(signed char *dest, unsigned numBytes) override;
+
+private:
+  bool OpenDecoder();
+
+  void CloseDecoder();
+
+  /// Decodes the next frame into mPending, false at the end of the file.
+  bool DecodeFrame();
+
+  /// Appends the next chunk of the file to mInput, false at its end.
+  bool ReadInput();
+
+  Urho3D::SharedPtr<Urho3D::File> mFile;
+  stb_vorbis *mDecoder;
+  std::vector<unsigned char> mInput;
+  std::size_t mInputStart;
+  std::vector<short> mPending;
+  std::size_t mPendingStart;
+  unsigned mChannels;
+  unsigned mFrequency;
+  bool mLooped;
+  bool mAtEnd;
+  SpscRing<short, RING_SAMPLES> mRing;
+};
+
+#endif // NINPOTEST_MUSICSTREAM_H
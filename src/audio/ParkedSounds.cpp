@@ -0,0 +1,81 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+
+#include "ParkedSounds.h"
+
+ParkedSounds::ParkedSounds(entityx::EventManager &events,
+                           unsigned maxPerSample)
+    : mMaxPerSample(maxPerSample), mCount(0) {
+  events.subscribe<entityx::EntityDestroyedEvent>(*this);
+}
+
+void ParkedSounds::receive(const entityx::EntityDestroyedEvent &event) {
+  if (mByParent.Empty()) {
+    return;
+  }
+  auto itr = mByParent.Find(event.entity.id().id());
+  if (itr != mByParent.End()) {
+    mCount -= itr->second.size();
+    mByParent.Erase(itr);
+  }
+}
+
+bool ParkedSounds::Park(entityx::Entity entity, const Sound &sound,
+                        entityx::Entity::Id parentId) {
+  auto key = SoundKey::Make(sound, parentId);
+  auto &parked = mByParent[key.parent];
+  unsigned sameSample = 0;
+  for (const auto &entry : parked) {
+    if (entry.key == key && ++sameSample >= mMaxPerSample) {
+      return false;
+    }
+  }
+  parked.push_back(Parked{key, entity});
+  ++mCount;
+  return true;
+}
+
+entityx::Entity ParkedSounds::Take(const Sound &sound,
+                                   entityx::Entity::Id parentId) {
+  auto key = SoundKey::Make(sound, parentId);
+  auto itr = mByParent.Find(key.parent);
+  if (itr == mByParent.End()) {
+    return entityx::Entity();
+  }
+  auto &parked = itr->second;
+  for (auto i = parked.size(); i-- > 0;) {
+    if (!(parked[i].key == key)) {
+      continue;
+    }
+    auto entity = parked[i].entity;
+    parked[i] = parked.back();
+    parked.pop_back();
+    --mCount;
+    // NOTE: A parked entity may have been destroyed on its own since
+    if (entity.valid() && entity.has_component<Sound>()) {
+      return entity;
+    }
+  }
+  return entityx::Entity();
+}
@@ -0,0 +1,83 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+
+#ifndef NINPOTEST_PARKEDSOUNDS_H
+#define NINPOTEST_PARKEDSOUNDS_H
+
+#include "../common/FlatHashMap.h"
+#include "../components/Sound.h"
+#include "SoundKey.h"
+
+#include <entityx/Entity.h>
+#include <entityx/Event.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Finished reusable sound entities, see Sound::isReusable, waiting to be
+ * handed out again by the next request for the same sample on the same
+ * parent.
+ *
+ * At most `maxPerSample` entities are kept per sample and parent, a burst of
+ * requests beyond that is destroyed once it finishes. Whatever was parked on
+ * a parent is forgotten when the parent is destroyed.
+ */
+class ParkedSounds : public entityx::Receiver<ParkedSounds> {
+public:
+  static constexpr unsigned DEFAULT_MAX_PER_SAMPLE = 4;
+
+  explicit ParkedSounds(entityx::EventManager &events,
+                        unsigned maxPerSample = DEFAULT_MAX_PER_SAMPLE);
+
+  void receive(const entityx::EntityDestroyedEvent &event);
+
+  /**
+   * Keeps the entity for reuse.
+   *
+   * @return false when enough entities with the same sample are parked on the
+   * parent already, the entity should be destroyed instead
+   */
+  bool Park(entityx::Entity entity, const Sound &sound,
+            entityx::Entity::Id parentId);
+
+  /// Takes an entity that played the same sample on the same parent.
+  entityx::Entity Take(const Sound &sound, entityx::Entity::Id parentId);
+
+  /// Entities parked at the moment.
+  std::size_t GetCount() const { return mCount; }
+
+private:
+  struct Parked {
+    SoundKey key;
+    entityx::Entity entity;
+  };
+
+  unsigned mMaxPerSample;
+  // NOTE: Grouped by parent so destroying one drops its entries in one go
+  FlatHashMap<std::uint64_t, std::vector<Parked>> mByParent;
+  std::size_t mCount;
+};
+
+#endif // NINPOTEST_PARKEDSOUNDS_H
@@ -0,0 +1,210 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "SoundBank.h"
+#include "../common/GameLog.h"
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#include <STB/stb_vorbis.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+std::uint32_t ReadUInt32(const unsigned char *data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) |
+         (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+std::uint16_t ReadUInt16(const unsigned char *data) {
+  return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+}
+} // namespace
+
+SoundBank::SoundBank(Urho3D::Context *context) : Urho3D::Object(context) {}
+
+void SoundBank::Load(const Urho3D::Vector<Urho3D::String> &manifest) {
+  auto resources = GetSubsystem<Urho3D::ResourceCache>();
+  auto workQueue = GetSubsystem<Urho3D::WorkQueue>();
+  auto first = mEntries.size();
+  for (const auto &name : manifest) {
+    if (mIndex.Contains(name)) {
+      continue;
+    }
+    auto entry = new Entry();
+    entry->name = name;
+    mIndex[name] = static_cast<unsigned>(mEntries.size());
+    mEntries.emplace_back(entry);
+
+    Urho3D::SharedPtr<Urho3D::WorkItem> item = workQueue->GetFreeItem();
+    item->priority_ = Urho3D::M_MAX_UNSIGNED;
+    item->workFunction_ = DecodeWork;
+    item->start_ = entry;
+    item->aux_ = resources;
+    item->sendEvent_ = false;
+    workQueue->AddWorkItem(item);
+  }
+  // The main thread picks up jobs too while it waits
+  workQueue->Complete(Urho3D::M_MAX_UNSIGNED);
+
+  // NOTE: No handle to the new entries was handed out yet, so the ones that
+  // failed are dropped and the others moved down in their place. Find then
+  // reports the failed files as missing.
+  auto kept = first;
+  for (auto i = first; i < mEntries.size(); ++i) {
+    if (!mEntries[i]->decoded) {
+      GAME_LOGERRORF("Failed to decode sound '%s' for the sound bank",
+                     mEntries[i]->name.CString());
+      mIndex.Erase(mEntries[i]->name);
+      continue;
+    }
+    if (kept != i) {
+      mEntries[kept] = std::move(mEntries[i]);
+      mIndex[mEntries[kept]->name] = static_cast<unsigned>(kept);
+    }
+    auto &entry = *mEntries[kept++];
+    // NOTE: Urho3D::Sound owns its sample buffer, so the decoded samples are
+    // copied once here and the staging buffer is dropped right after
+    entry.sound = new Urho3D::Sound(context_);
+    entry.sound->SetName(entry.name);
+    entry.sound->SetSize(static_cast<unsigned>(entry.samples.size()));
+    std::memcpy(entry.sound->GetStart(), entry.samples.data(),
+                entry.samples.size());
+    entry.sound->SetFormat(entry.frequency, entry.sixteenBit, entry.stereo);
+    std::vector<signed char>().swap(entry.samples);
+  }
+  mEntries.resize(kept);
+  GAME_LOGINFOF("Sound bank holds %u sounds in %u KiB", GetNumSounds(),
+                static_cast<unsigned>(GetMemoryUse() / 1024));
+}
+
+SoundHandle SoundBank::Find(const char *name) const {
+  auto itr = mIndex.Find(name);
+  if (itr == mIndex.End()) {
+    return SoundHandle{};
+  }
+  return SoundHandle{itr->second};
+}
+
+std::size_t SoundBank::GetMemoryUse() const {
+  std::size_t bytes = 0;
+  for (const auto &entry : mEntries) {
+    if (entry->sound) {
+      bytes += entry->sound->GetDataSize();
+    }
+  }
+  return bytes;
+}
+
+void SoundBank::DecodeWork(const Urho3D::WorkItem *item,
+                           unsigned threadIndex) {
+  auto &entry = *static_cast<Entry *>(item->start_);
+  auto resources = static_cast<Urho3D::ResourceCache *>(item->aux_);
+  // ResourceCache::GetFile is safe to call from worker threads, it is what
+  // background resource loading uses too
+  auto file = resources->GetFile(entry.name, false);
+  if (!file) {
+    return;
+  }
+  std::vector<unsigned char> data(file->GetSize());
+  if (file->Read(data.data(), static_cast<unsigned>(data.size())) !=
+      data.size()) {
+    return;
+  }
+  if (entry.name.EndsWith(".ogg", false)) {
+    entry.decoded = DecodeOggVorbis(entry, data.data(), data.size());
+  } else {
+    entry.decoded = DecodeWav(entry, data.data(), data.size());
+  }
+}
+
+bool SoundBank::DecodeWav(Entry &entry, const unsigned char *data,
+                          std::size_t size) {
+  if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 ||
+      std::memcmp(data + 8, "WAVE", 4) != 0) {
+    return false;
+  }
+  bool hasFormat = false;
+  std::size_t offset = 12;
+  while (offset + 8 <= size) {
+    auto chunk = data + offset;
+    std::size_t chunkSize = ReadUInt32(chunk + 4);
+    auto body = chunk + 8;
+    if (offset + 8 + chunkSize > size) {
+      chunkSize = size - offset - 8;
+    }
+    if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16) {
+      auto format = ReadUInt16(body);
+      auto channels = ReadUInt16(body + 2);
+      auto bits = ReadUInt16(body + 14);
+      // 0xfffe is WAVE_FORMAT_EXTENSIBLE, which is still integer PCM here
+      if ((format != 1 && format != 0xfffe) || channels < 1 || channels > 2 ||
+          (bits != 8 && bits != 16)) {
+        return false;
+      }
+      entry.frequency = ReadUInt32(body + 4);
+      entry.stereo = channels == 2;
+      entry.sixteenBit = bits == 16;
+      hasFormat = true;
+    } else if (std::memcmp(chunk, "data", 4) == 0 && hasFormat) {
+      entry.samples.resize(chunkSize);
+      std::memcpy(entry.samples.data(), body, chunkSize);
+      if (!entry.sixteenBit) {
+        // WAV stores 8-bit samples unsigned, Urho3D mixes them signed
+        for (auto &sample : entry.samples) {
+          sample = static_cast<signed char>(
+              static_cast<unsigned char>(sample) - 128);
+        }
+      }
+      return true;
+    }
+    // Chunks are padded to an even size
+    offset += 8 + chunkSize + (chunkSize & 1);
+  }
+  return false;
+}
+
+bool SoundBank::DecodeOggVorbis(Entry &entry, const unsigned char *data,
+                                std::size_t size) {
+  int channels = 0;
+  int sampleRate = 0;
+  short *output = nullptr;
+  int frames = stb_vorbis_decode_memory(data, static_cast<int>(size),
+                                        &channels, &sampleRate, &output);
+  if (frames <= 0 || output == nullptr || channels < 1 || channels > 2) {
+    std::free(output);
+    return false;
+  }
+  auto bytes = static_cast<std::size_t>(frames) * channels * sizeof(short);
+  entry.samples.resize(bytes);
+  std::memcpy(entry.samples.data(), output, bytes);
+  std::free(output);
+  entry.frequency = static_cast<unsigned>(sampleRate);
+  entry.sixteenBit = true;
+  entry.stereo = channels == 2;
+  return true;
+}
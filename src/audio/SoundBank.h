@@ -0,0 +1,97 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_SOUNDBANK_H
+#define NINPOTEST_SOUNDBANK_H
+
+#include "../common/FlatHashMap.h"
+#include "SoundHandle.h"
+
+#include <Urho3D/Audio/Sound.h>
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Container/Vector.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * Memory resident sound effects. A manifest of WAV and Ogg Vorbis files is
+ * read and decoded to PCM on the WorkQueue threads in one go, usually when a
+ * state starts. Afterwards playing a sound is a handle lookup, without going
+ * through the resource cache or the file system.
+ *
+ * The owning GameState registers it as a subsystem.
+ */
+class SoundBank : public Urho3D::Object {
+  URHO3D_OBJECT(SoundBank, Urho3D::Object)
+public:
+  explicit SoundBank(Urho3D::Context *context);
+
+  /**
+   * Decodes every file of the manifest that isn't in the bank yet, in
+   * parallel, and waits until all of them are ready. Files that cannot be
+   * decoded are logged and left out, Find returns an invalid handle for them.
+   */
+  void Load(const Urho3D::Vector<Urho3D::String> &manifest);
+
+  SoundHandle Find(const char *name) const;
+
+  Urho3D::Sound *Get(SoundHandle handle) const {
+    return handle.index < mEntries.size() ? mEntries[handle.index]->sound.Get()
+                                          : nullptr;
+  }
+
+  unsigned GetNumSounds() const { return static_cast<unsigned>(mEntries.size()); }
+
+  /// Bytes of decoded samples held by the bank.
+  std::size_t GetMemoryUse() const;
+
+private:
+  struct Entry {
+    Urho3D::String name;
+    Urho3D::SharedPtr<Urho3D::Sound> sound;
+    /// Output of the decoding job, moved into `sound` once it is done.
+    std::vector<signed char> samples;
+    unsigned frequency = 0;
+    bool sixteenBit = false;
+    bool stereo = false;
+    bool decoded = false;
+  };
+
+  static void DecodeWork(const Urho3D::WorkItem *item, unsigned threadIndex);
+
+  static bool DecodeWav(Entry &entry, const unsigned char *data,
+                        std::size_t size);
+
+  static bool DecodeOggVorbis(Entry &entry, const unsigned char *data,
+                              std::size_t size);
+
+  // NOTE: Entries are heap allocated so the decoding jobs can hold on to them
+  // while the vector grows
+  std::vector<std::unique_ptr<Entry>> mEntries;
+  FlatHashMap<Urho3D::String, unsigned, StringKeyHash, StringKeyEqual> mIndex;
+};
+
+#endif // NINPOTEST_SOUNDBANK_H
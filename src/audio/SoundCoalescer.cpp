@@ -0,0 +1,96 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "SoundCoalescer.h"
+
+#include <algorithm>
+#include <cmath>
+
+SoundCoalescer::SoundCoalescer(Urho3D::Time *time,
+                               const CoalesceSettings &settings)
+    : mTime(time), mSettings(settings), mLastPruneFrame(0), mRequestCount(0),
+      mCoalescedCount(0) {}
+
+bool SoundCoalescer::Merge(const Sound &sound, entityx::Entity::Id parentId) {
+  ++mRequestCount;
+  if (!mTime || sound.isLooped) {
+    return false;
+  }
+  auto frame = mTime->GetFrameNumber();
+  auto time = mTime->GetElapsedTime();
+  Prune(frame, time);
+
+  auto itr = mRecent.Find(SoundKey::Make(sound, parentId));
+  if (itr == mRecent.End()) {
+    return false;
+  }
+  auto &entry = itr->second;
+  auto playing = entry.entity.valid()
+                     ? entry.entity.component<Sound>()
+                     : entityx::ComponentHandle<Sound>();
+  if (!playing || IsExpired(entry, frame, time)) {
+    mRecent.Erase(itr);
+    return false;
+  }
+  entry.power += sound.gain * sound.gain;
+  playing->gain = std::min(mSettings.maxGain, std::sqrt(entry.power));
+  ++mCoalescedCount;
+  return true;
+}
+
+void SoundCoalescer::Track(entityx::Entity entity, const Sound &sound,
+                           entityx::Entity::Id parentId) {
+  if (!mTime || sound.isLooped) {
+    return;
+  }
+  mRecent[SoundKey::Make(sound, parentId)] =
+      Entry{entity, sound.gain * sound.gain, mTime->GetFrameNumber(),
+            mTime->GetElapsedTime()};
+}
+
+void SoundCoalescer::Untrack(entityx::Entity entity, const Sound &sound,
+                             entityx::Entity::Id parentId) {
+  auto itr = mRecent.Find(SoundKey::Make(sound, parentId));
+  if (itr != mRecent.End() && itr->second.entity == entity) {
+    mRecent.Erase(itr);
+  }
+}
+
+bool SoundCoalescer::IsExpired(const Entry &entry, unsigned frame,
+                               float time) const {
+  return entry.frame != frame && time - entry.time > mSettings.window;
+}
+
+void SoundCoalescer::Prune(unsigned frame, float time) {
+  if (frame == mLastPruneFrame || mRecent.Empty()) {
+    return;
+  }
+  mLastPruneFrame = frame;
+  for (auto itr = mRecent.Begin(); itr != mRecent.End();) {
+    if (IsExpired(itr->second, frame, time)) {
+      itr = mRecent.Erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+}
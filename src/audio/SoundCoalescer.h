@@ -0,0 +1,105 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_SOUNDCOALESCER_H
+#define NINPOTEST_SOUNDCOALESCER_H
+
+#include "../common/FlatHashMap.h"
+#include "../components/Sound.h"
+#include "SoundKey.h"
+
+#include <entityx/Entity.h>
+
+#include <Urho3D/Core/Timer.h>
+
+#include <cstdint>
+
+struct CoalesceSettings {
+  /// Seconds during which identical requests merge. 0 merges only requests
+  /// made within the same frame.
+  float window = 0.0f;
+  /// Upper bound of the gain of a merged voice.
+  float maxGain = 2.0f;
+};
+
+/**
+ * Merges identical one-shot sound requests. Requests for the same sample on
+ * the same parent made within the coalescing window end up as a single voice
+ * instead of several sources playing the same sample in phase. Each merged
+ * request raises the gain of that voice as if their power was summed.
+ *
+ * Looping sounds are never merged.
+ */
+class SoundCoalescer {
+public:
+  explicit SoundCoalescer(Urho3D::Time *time,
+                          const CoalesceSettings &settings = CoalesceSettings());
+
+  const CoalesceSettings &GetSettings() const { return mSettings; }
+
+  void SetSettings(const CoalesceSettings &settings) { mSettings = settings; }
+
+  /**
+   * Tries to merge the request into a sound played recently.
+   *
+   * @return true when merged, no entity should be created for the request
+   */
+  bool Merge(const Sound &sound, entityx::Entity::Id parentId);
+
+  /// Registers the entity created for a request that could not be merged.
+  void Track(entityx::Entity entity, const Sound &sound,
+             entityx::Entity::Id parentId);
+
+  /// Stops merging requests into the entity, e.g. because it finished.
+  void Untrack(entityx::Entity entity, const Sound &sound,
+               entityx::Entity::Id parentId);
+
+  /// Requests seen since startup.
+  std::uint64_t GetRequestCount() const { return mRequestCount; }
+
+  /// Requests merged into an earlier one since startup.
+  std::uint64_t GetCoalescedCount() const { return mCoalescedCount; }
+
+private:
+  struct Entry {
+    entityx::Entity entity;
+    /// Sum of the squared gains of the merged requests.
+    float power;
+    unsigned frame;
+    float time;
+  };
+
+  bool IsExpired(const Entry &entry, unsigned frame, float time) const;
+
+  /// Drops expired entries, at most once per frame.
+  void Prune(unsigned frame, float time);
+
+  Urho3D::Time *mTime;
+  CoalesceSettings mSettings;
+  FlatHashMap<SoundKey, Entry, SoundKeyHash> mRecent;
+  unsigned mLastPruneFrame;
+  std::uint64_t mRequestCount;
+  std::uint64_t mCoalescedCount;
+};
+
+#endif // NINPOTEST_SOUNDCOALESCER_H
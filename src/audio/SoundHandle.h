@@ -0,0 +1,47 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_SOUNDHANDLE_H
+#define NINPOTEST_SOUNDHANDLE_H
+
+/**
+ * Refers to a sound that has been preloaded into the SoundBank. Handles stay
+ * valid for the lifetime of the bank.
+ */
+struct SoundHandle {
+  static constexpr unsigned INVALID_INDEX = ~0u;
+
+  unsigned index = INVALID_INDEX;
+
+  bool IsValid() const { return index != INVALID_INDEX; }
+
+  bool operator==(const SoundHandle &other) const {
+    return index == other.index;
+  }
+
+  bool operator!=(const SoundHandle &other) const {
+    return index != other.index;
+  }
+};
+
+#endif // NINPOTEST_SOUNDHANDLE_H
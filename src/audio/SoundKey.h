@@ -0,0 +1,69 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_SOUNDKEY_H
+#define NINPOTEST_SOUNDKEY_H
+
+#include "../common/FlatHashMap.h"
+#include "../components/Sound.h"
+
+#include <entityx/Entity.h>
+
+#include <Urho3D/Math/StringHash.h>
+
+#include <cstdint>
+
+/**
+ * Identifies the sample a sound plays along with the entity it is attached
+ * to. Sounds with the same key are interchangeable apart from their gain.
+ */
+struct SoundKey {
+  static SoundKey Make(const Sound &sound, entityx::Entity::Id parentId) {
+    if (sound.handle.IsValid()) {
+      return SoundKey{parentId.id(), sound.handle.index, true};
+    }
+    return SoundKey{parentId.id(), Urho3D::StringHash(sound.value).Value(),
+                    false};
+  }
+
+  bool operator==(const SoundKey &other) const {
+    return parent == other.parent && sample == other.sample &&
+           isHandle == other.isHandle;
+  }
+
+  std::uint64_t parent;
+  /// Bank handle index, or the hash of the file name.
+  unsigned sample;
+  bool isHandle;
+};
+
+struct SoundKeyHash {
+  std::size_t operator()(const SoundKey &key) const {
+    return FlatHash<std::uint64_t>()(
+        key.parent ^ (static_cast<std::uint64_t>(key.sample) << 1 |
+                      static_cast<std::uint64_t>(key.isHandle)) *
+                         0x9e3779b97f4a7c15ULL);
+  }
+};
+
+#endif // NINPOTEST_SOUNDKEY_H
@@ -0,0 +1,206 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "VoiceManager.h"
+
+#include <Urho3D/Audio/Sound.h>
+#include <Urho3D/Audio/SoundListener.h>
+#include <Urho3D/Scene/Node.h>
+
+#include <algorithm>
+#include <cmath>
+
+VoiceManager::VoiceManager(Urho3D::Audio *audio, const VoiceSettings &settings)
+    : mAudio(audio), mSettings(settings), mSequence(0), mStolenCount(0),
+      mRealCount(0) {}
+
+bool VoiceManager::Add(Urho3D::SoundSource3D &source, int priority) {
+  if (mIndex.Contains(&source)) {
+    return !IsVirtual(source);
+  }
+  Urho3D::Vector3 listenerPosition;
+  const Urho3D::Vector3 *listener =
+      GetListenerPosition(listenerPosition) ? &listenerPosition : nullptr;
+  mIndex[&source] = mVoices.size();
+  mVoices.push_back(Voice{&source, priority, mSequence++, 0.0f,
+                          GetAudibility(source, listener), false});
+  ++mRealCount;
+  // NOTE: Whether it deserves a voice more than a playing one is left to the
+  // next ranking, a full budget is not reshuffled for every spawn
+  auto &voice = mVoices.back();
+  if (voice.audibility < mSettings.audibilityThreshold ||
+      mRealCount > mSettings.maxVoices) {
+    Virtualize(voice);
+  }
+  return !voice.isVirtual;
+}
+
+void VoiceManager::Remove(Urho3D::SoundSource3D &source) {
+  auto itr = mIndex.Find(&source);
+  if (itr == mIndex.End()) {
+    return;
+  }
+  auto index = itr->second;
+  if (!mVoices[index].isVirtual) {
+    --mRealCount;
+  }
+  RemoveAt(index);
+}
+
+bool VoiceManager::IsVirtual(const Urho3D::SoundSource3D &source) const {
+  auto itr = mIndex.Find(&source);
+  return itr != mIndex.End() && mVoices[itr->second].isVirtual;
+}
+
+void VoiceManager::RemoveAt(std::size_t index) {
+  mIndex.Erase(mVoices[index].source);
+  if (index + 1 != mVoices.size()) {
+    mVoices[index] = mVoices.back();
+    mIndex[mVoices[index].source] = index;
+  }
+  mVoices.pop_back();
+}
+
+void VoiceManager::Update(float timeStep) {
+  Urho3D::Vector3 listenerPosition;
+  const Urho3D::Vector3 *listener =
+      GetListenerPosition(listenerPosition) ? &listenerPosition : nullptr;
+
+  for (std::size_t i = 0; i < mVoices.size();) {
+    auto &voice = mVoices[i];
+    if (!voice.isVirtual) {
+      voice.position = voice.source->GetTimePosition();
+    } else {
+      voice.position += timeStep;
+      auto sound = voice.source->GetSound();
+      if (sound && !sound->IsLooped() && voice.position >= sound->GetLength()) {
+        // Let Urho3D report the end of the sound as if it had been mixed
+        voice.source->SetEnabled(true);
+        voice.source->Stop();
+        RemoveAt(i);
+        continue;
+      }
+    }
+    voice.audibility = GetAudibility(*voice.source, listener);
+    ++i;
+  }
+  Allocate();
+}
+
+bool VoiceManager::GetListenerPosition(Urho3D::Vector3 &position) const {
+  auto listener = mAudio ? mAudio->GetListener() : nullptr;
+  if (!listener || !listener->GetNode()) {
+    return false;
+  }
+  position = listener->GetNode()->GetWorldPosition();
+  return true;
+}
+
+float VoiceManager::GetAudibility(
+    const Urho3D::SoundSource3D &source,
+    const Urho3D::Vector3 *listenerPosition) const {
+  auto gain = source.GetGain();
+  auto node = source.GetNode();
+  if (!listenerPosition || !node) {
+    return gain;
+  }
+  // Same attenuation as SoundSource3D applies when mixing
+  auto distance = (node->GetWorldPosition() - *listenerPosition).Length();
+  auto nearDistance = source.GetNearDistance();
+  auto farDistance = source.GetFarDistance();
+  if (distance <= nearDistance) {
+    return gain;
+  }
+  if (distance >= farDistance) {
+    return 0.0f;
+  }
+  auto attenuation =
+      1.0f - (distance - nearDistance) / (farDistance - nearDistance);
+  return gain * std::pow(attenuation, source.GetRolloffFactor());
+}
+
+void VoiceManager::Allocate() {
+  mRanking.clear();
+  for (std::size_t i = 0; i < mVoices.size(); ++i) {
+    if (mVoices[i].audibility >= mSettings.audibilityThreshold) {
+      mRanking.push_back(i);
+    }
+  }
+  // NOTE: Only which voices make the budget matters, not their order
+  std::size_t budget = std::min<std::size_t>(mSettings.maxVoices,
+                                             mRanking.size());
+  if (budget < mRanking.size()) {
+    std::nth_element(mRanking.begin(), mRanking.begin() + budget,
+                     mRanking.end(),
+                     [this](std::size_t left, std::size_t right) {
+                       const auto &a = mVoices[left];
+                       const auto &b = mVoices[right];
+                       if (a.priority != b.priority) {
+                         return a.priority > b.priority;
+                       }
+                       if (a.audibility != b.audibility) {
+                         return a.audibility > b.audibility;
+                       }
+                       return a.sequence > b.sequence;
+                     });
+  }
+
+  // Voices falling out of the budget or out of earshot go virtual first, so
+  // the real voice count never exceeds the budget in between
+  for (std::size_t rank = budget; rank < mRanking.size(); ++rank) {
+    auto &voice = mVoices[mRanking[rank]];
+    if (!voice.isVirtual) {
+      ++mStolenCount;
+      Virtualize(voice);
+    }
+  }
+  for (auto &voice : mVoices) {
+    if (!voice.isVirtual &&
+        voice.audibility < mSettings.audibilityThreshold) {
+      Virtualize(voice);
+    }
+  }
+  for (std::size_t rank = 0; rank < budget; ++rank) {
+    auto &voice = mVoices[mRanking[rank]];
+    if (voice.isVirtual) {
+      Realize(voice);
+    }
+  }
+}
+
+void VoiceManager::Virtualize(Voice &voice) {
+  voice.source->SetEnabled(false);
+  voice.isVirtual = true;
+  --mRealCount;
+}
+
+void VoiceManager::Realize(Voice &voice) {
+  auto sound = voice.source->GetSound();
+  if (sound && sound->IsLooped() && sound->GetLength() > 0.0f) {
+    voice.position = std::fmod(voice.position, sound->GetLength());
+  }
+  voice.source->SetEnabled(true);
+  voice.source->Seek(voice.position);
+  voice.isVirtual = false;
+  ++mRealCount;
+}
@@ -0,0 +1,130 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_VOICEMANAGER_H
+#define NINPOTEST_VOICEMANAGER_H
+
+#include <Urho3D/Audio/Audio.h>
+#include <Urho3D/Audio/SoundSource3D.h>
+
+#include "../common/FlatHashMap.h"
+
+#include <cstdint>
+#include <vector>
+
+struct VoiceSettings {
+  /// Voices mixed at the same time; any further voices are virtual.
+  unsigned maxVoices = 24;
+  /// Voices whose gain at the listener is below this are virtual.
+  float audibilityThreshold = 0.01f;
+};
+
+/**
+ * Keeps the number of sound sources Urho3D mixes within a budget.
+ *
+ * Every frame the playing voices are ranked by priority, then by how loud
+ * they are at the listener. The best `maxVoices` audible ones are mixed, the
+ * others are made virtual: their source is disabled, so the audio thread
+ * skips it, while their playback position keeps being tracked here. A voice
+ * that becomes relevant again resumes where it would have been. When a
+ * virtual voice runs out it is stopped for real, so the usual sound finished
+ * handling still takes place.
+ *
+ * Voices should be added before they start playing, so that one starting out
+ * of earshot is never mixed at all. Adding and removing voices is constant
+ * time; a voice added while the budget is used up starts out virtual and is
+ * ranked with the others on the next Update.
+ */
+class VoiceManager {
+public:
+  explicit VoiceManager(Urho3D::Audio *audio,
+                        const VoiceSettings &settings = VoiceSettings());
+
+  const VoiceSettings &GetSettings() const { return mSettings; }
+
+  void SetSettings(const VoiceSettings &settings) { mSettings = settings; }
+
+  /**
+   * Starts managing a source that is about to start playing.
+   *
+   * @return false when the voice starts out virtual
+   */
+  bool Add(Urho3D::SoundSource3D &source, int priority);
+
+  void Remove(Urho3D::SoundSource3D &source);
+
+  bool IsVirtual(const Urho3D::SoundSource3D &source) const;
+
+  /// Ranks the voices and assigns the budget. Call once per frame.
+  void Update(float timeStep);
+
+  unsigned GetRealCount() const { return mRealCount; }
+
+  unsigned GetVirtualCount() const {
+    return static_cast<unsigned>(mVoices.size()) - mRealCount;
+  }
+
+  /// Audible voices virtualized to make room for others, since startup.
+  std::uint64_t GetStolenCount() const { return mStolenCount; }
+
+private:
+  struct Voice {
+    Urho3D::SoundSource3D *source;
+    int priority;
+    /// Order in which voices started, newer voices win ties.
+    std::uint64_t sequence;
+    /// Playback position in seconds, advanced here while virtual.
+    float position;
+    /// Gain at the listener.
+    float audibility;
+    bool isVirtual;
+  };
+
+  /// Position of the active listener, false when there is none.
+  bool GetListenerPosition(Urho3D::Vector3 &position) const;
+
+  float GetAudibility(const Urho3D::SoundSource3D &source,
+                      const Urho3D::Vector3 *listenerPosition) const;
+
+  void Virtualize(Voice &voice);
+
+  void Realize(Voice &voice);
+
+  /// Removes the voice at `index`, moving the last voice into its place.
+  void RemoveAt(std::size_t index);
+
+  /// Assigns the voice budget and applies the resulting changes.
+  void Allocate();
+
+  Urho3D::Audio *mAudio;
+  VoiceSettings mSettings;
+  std::vector<Voice> mVoices;
+  /// Index of every managed source in mVoices.
+  FlatHashMap<const Urho3D::SoundSource3D *, std::size_t> mIndex;
+  std::vector<std::size_t> mRanking;
+  std::uint64_t mSequence;
+  std::uint64_t mStolenCount;
+  unsigned mRealCount;
+};
+
+#endif // NINPOTEST_VOICEMANAGER_H
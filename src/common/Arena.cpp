@@ -0,0 +1,135 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+LinearArena::LinearArena(std::size_t blockSize)
+    : mBlockSize(blockSize), mCurrent(nullptr), mCursor(nullptr),
+      mEnd(nullptr), mUsedInPreviousBlocks(0), mCapacity(0),
+      mHighWaterMark(0), mBlockCount(0) {}
+
+LinearArena::~LinearArena() { FreeBlocks(); }
+
+void *LinearArena::AllocateSlow(std::size_t size, std::size_t alignment) {
+  if (mCurrent != nullptr) {
+    mUsedInPreviousBlocks += mCursor - mCurrent->Begin();
+  }
+  // Double the arena each time it overflows so that a frame needs a logarithmic
+  // number of blocks at most, even before the first reset collapses them
+  PushBlock(std::max({mBlockSize, mCapacity, size + alignment}));
+  return Allocate(size, alignment);
+}
+
+void LinearArena::PushBlock(std::size_t size) {
+  auto memory = std::malloc(sizeof(Block) + size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  auto block = ::new (memory) Block{mCurrent, size};
+  mCurrent = block;
+  mCursor = block->Begin();
+  mEnd = mCursor + size;
+  mCapacity += size;
+  ++mBlockCount;
+}
+
+void LinearArena::FreeBlocks() {
+  while (mCurrent != nullptr) {
+    auto previous = mCurrent->previous;
+    std::free(mCurrent);
+    mCurrent = previous;
+  }
+  mCursor = nullptr;
+  mEnd = nullptr;
+  mCapacity = 0;
+  mBlockCount = 0;
+}
+
+void LinearArena::Reset() {
+  mHighWaterMark = std::max(mHighWaterMark, GetUsed());
+  mUsedInPreviousBlocks = 0;
+  if (mBlockCount > 1) {
+    auto capacity = mCapacity;
+    FreeBlocks();
+    PushBlock(capacity);
+  } else if (mCurrent != nullptr) {
+    mCursor = mCurrent->Begin();
+  }
+}
+
+std::size_t LinearArena::GetUsed() const {
+  if (mCurrent == nullptr) {
+    return 0;
+  }
+  return mUsedInPreviousBlocks + (mCursor - mCurrent->Begin());
+}
+
+ArenaStringBuilder::ArenaStringBuilder(LinearArena &arena,
+                                       std::size_t capacity)
+    : mBuffer(ArenaAllocator<char>(arena)) {
+  // Anything above the small string capacity of every standard library
+  mBuffer.reserve(std::max<std::size_t>(capacity, 32));
+}
+
+ArenaStringBuilder &ArenaStringBuilder::Append(const char *text) {
+  mBuffer.append(text);
+  return *this;
+}
+
+ArenaStringBuilder &ArenaStringBuilder::Append(const char *text,
+                                               std::size_t length) {
+  mBuffer.append(text, length);
+  return *this;
+}
+
+ArenaStringBuilder &ArenaStringBuilder::Append(char character) {
+  mBuffer.push_back(character);
+  return *this;
+}
+
+ArenaStringBuilder &ArenaStringBuilder::AppendFormat(const char *format, ...) {
+  char local[128];
+  va_list args;
+  va_start(args, format);
+  int length = std::vsnprintf(local, sizeof(local), format, args);
+  va_end(args);
+  if (length < 0) {
+    return *this;
+  }
+  if (static_cast<std::size_t>(length) < sizeof(local)) {
+    mBuffer.append(local, length);
+    return *this;
+  }
+  auto offset = mBuffer.size();
+  mBuffer.resize(offset + length);
+  va_start(args, format);
+  std::vsnprintf(&mBuffer[offset], length + 1, format, args);
+  va_end(args);
+  return *this;
+}
@@ -0,0 +1,199 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_ARENA_H
+#define NINPOTEST_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Bump allocator for short lived data. Allocating only moves a cursor and
+ * nothing is freed individually; all memory is reclaimed at once with
+ * `Reset`. Destructors of objects placed in the arena are never run, so it is
+ * meant for trivially destructible data or containers using ArenaAllocator.
+ *
+ * When a frame does not fit in the current block a new one is chained. On the
+ * next reset the chain is collapsed into a single block big enough for the
+ * whole frame, so steady state frames never reach the general heap.
+ */
+class LinearArena {
+public:
+  static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  explicit LinearArena(std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+  ~LinearArena();
+
+  LinearArena(const LinearArena &) = delete;
+  LinearArena &operator=(const LinearArena &) = delete;
+
+  inline void *Allocate(std::size_t size,
+                        std::size_t alignment = alignof(std::max_align_t)) {
+    auto cursor = reinterpret_cast<std::uintptr_t>(mCursor);
+    auto aligned = (cursor + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+    if (mCursor != nullptr &&
+        aligned + size <= reinterpret_cast<std::uintptr_t>(mEnd)) {
+      mCursor = reinterpret_cast<char *>(aligned + size);
+      return reinterpret_cast<void *>(aligned);
+    }
+    return AllocateSlow(size, alignment);
+  }
+
+  template <typename T> T *AllocateArray(std::size_t count) {
+    return static_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
+  }
+
+  template <typename T, typename... Args> T *New(Args &&... args) {
+    return ::new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Releases everything allocated since the last reset. Any pointer handed
+   * out before is invalid afterwards.
+   */
+  void Reset();
+
+  /// Bytes handed out since the last reset, including alignment padding.
+  std::size_t GetUsed() const;
+
+  /// Bytes reserved from the heap.
+  std::size_t GetCapacity() const { return mCapacity; }
+
+  /// Largest `GetUsed` seen at a reset.
+  std::size_t GetHighWaterMark() const { return mHighWaterMark; }
+
+  /// Number of blocks chained in the current frame.
+  std::size_t GetBlockCount() const { return mBlockCount; }
+
+private:
+  struct Block {
+    Block *previous;
+    std::size_t size;
+
+    char *Begin() { return reinterpret_cast<char *>(this + 1); }
+  };
+
+  void *AllocateSlow(std::size_t size, std::size_t alignment);
+
+  void PushBlock(std::size_t size);
+
+  void FreeBlocks();
+
+  std::size_t mBlockSize;
+  Block *mCurrent;
+  char *mCursor;
+  char *mEnd;
+  std::size_t mUsedInPreviousBlocks;
+  std::size_t mCapacity;
+  std::size_t mHighWaterMark;
+  std::size_t mBlockCount;
+};
+
+/**
+ * STL allocator handing out arena memory. Deallocation is a no-op; the
+ * memory comes back when the arena is reset, which must not happen while the
+ * container is still alive.
+ */
+template <typename T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(LinearArena &arena) noexcept : mArena(&arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+      : mArena(other.GetArena()) {}
+
+  T *allocate(std::size_t count) { return mArena->AllocateArray<T>(count); }
+
+  void deallocate(T *, std::size_t) noexcept {}
+
+  LinearArena *GetArena() const noexcept { return mArena; }
+
+  template <typename U> bool operator==(const ArenaAllocator<U> &other) const {
+    return mArena == other.GetArena();
+  }
+
+  template <typename U> bool operator!=(const ArenaAllocator<U> &other) const {
+    return mArena != other.GetArena();
+  }
+
+private:
+  LinearArena *mArena;
+};
+
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+using ArenaString =
+    std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+/**
+ * Builds text in arena memory, for log lines and UI strings that only live
+ * for the current frame. The buffer never uses the small string storage, so
+ * `CString` stays valid after the builder is gone, until the arena is reset.
+ */
+class ArenaStringBuilder {
+public:
+  explicit ArenaStringBuilder(LinearArena &arena, std::size_t capacity = 128);
+
+  ArenaStringBuilder &Append(const char *text);
+
+  ArenaStringBuilder &Append(const char *text, std::size_t length);
+
+  ArenaStringBuilder &Append(char character);
+
+  template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+  ArenaStringBuilder &Append(T value) {
+    if (std::is_floating_point<T>::value) {
+      return AppendFormat("%g", static_cast<double>(value));
+    } else if (std::is_signed<T>::value) {
+      return AppendFormat("%lld", static_cast<long long>(value));
+    }
+    return AppendFormat("%llu", static_cast<unsigned long long>(value));
+  }
+
+  ArenaStringBuilder &AppendFormat(const char *format, ...)
+#if defined(__GNUC__)
+      __attribute__((format(printf, 2, 3)))
+#endif
+      ;
+
+  void Clear() { mBuffer.clear(); }
+
+  void Reserve(std::size_t capacity) { mBuffer.reserve(capacity); }
+
+  const char *CString() const { return mBuffer.c_str(); }
+
+  std::size_t Length() const { return mBuffer.size(); }
+
+private:
+  ArenaString mBuffer;
+};
+
+#endif // NINPOTEST_ARENA_H
@@ -0,0 +1,62 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "ComponentPool.h"
+
+std::vector<ComponentPools::Entry *> &ComponentPools::Entries() {
+  static std::vector<Entry *> entries;
+  return entries;
+}
+
+void ComponentPools::GetStats(std::vector<ComponentPoolStats> &out) {
+  out.clear();
+  for (auto entry : Entries()) {
+    ComponentPoolStats stats{entry->name,      entry->elementSize,
+                             entry->blockSize, entry->alignment,
+                             entry->live,      entry->highWaterMark,
+                             0,                0,
+                             0};
+    for (auto pool : entry->pools) {
+      stats.capacity += pool->capacity();
+      stats.blocks += pool->chunks();
+    }
+    stats.bytes = stats.capacity * stats.elementSize;
+    out.push_back(stats);
+  }
+}
+
+std::size_t ComponentPools::GetTotalBytes() {
+  std::size_t bytes = 0;
+  for (auto entry : Entries()) {
+    for (auto pool : entry->pools) {
+      bytes += pool->capacity() * entry->elementSize;
+    }
+  }
+  return bytes;
+}
+
+ComponentPoolTracker::ComponentPoolTracker(entityx::EventManager &events) {
+  for (auto entry : ComponentPools::GetEntries()) {
+    mCounters.push_back(entry->createCounter(events));
+  }
+}
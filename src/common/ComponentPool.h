@@ -0,0 +1,254 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_COMPONENTPOOL_H
+#define NINPOTEST_COMPONENTPOOL_H
+
+#include <entityx/Entity.h>
+#include <entityx/help/Pool.h>
+
+#include "FrameCounters.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Snapshot of the memory held by the entityx pool of a single component type.
+ *
+ * NOTE: entityx indexes its pools by entity index, so a pool's capacity always
+ * covers every entity index handed out so far, regardless of how many entities
+ * actually carry the component. The ratio between `live` and `capacity` is
+ * therefore a good measure of how sparse (fragmented) a pool is.
+ */
+struct ComponentPoolStats {
+  const char *name;
+  /// Size of one slot, including alignment padding.
+  std::size_t elementSize;
+  /// Number of slots allocated at once when the pool grows.
+  std::size_t blockSize;
+  std::size_t alignment;
+  /// Components currently assigned.
+  std::size_t live;
+  /// Largest number of components assigned at the same time.
+  std::size_t highWaterMark;
+  /// Slots allocated across every block.
+  std::size_t capacity;
+  std::size_t blocks;
+  std::size_t bytes;
+};
+
+/**
+ * Pool parameters of a component type. Specialized through COMPONENT_POOL.
+ */
+template <typename T> struct ComponentPoolTraits;
+
+class ComponentPools {
+public:
+  struct Entry {
+    const char *name;
+    std::size_t elementSize;
+    std::size_t blockSize;
+    std::size_t alignment;
+    std::size_t reserved;
+    std::size_t live;
+    std::size_t highWaterMark;
+    std::vector<entityx::BasePool *> pools;
+    std::unique_ptr<entityx::BaseReceiver> (*createCounter)(
+        entityx::EventManager &events);
+  };
+
+  template <typename T> static Entry &GetEntry();
+
+  template <typename T> static bool Register() {
+    GetEntry<T>();
+    return true;
+  }
+
+  /**
+   * Makes sure that the pools of `T` can hold `count` components without
+   * growing. Pools that have not been created yet will reserve the space as
+   * soon as entityx instantiates them.
+   */
+  template <typename T> static void Reserve(std::size_t count) {
+    auto &entry = GetEntry<T>();
+    entry.reserved = std::max(entry.reserved, count);
+    for (auto pool : entry.pools) {
+      pool->reserve(count);
+    }
+  }
+
+  /**
+   * Like Reserve, but only grows the pool holding the `T` of `entity`, which
+   * has to have one. The pools of other entity managers and the ones created
+   * later keep their own capacity.
+   */
+  template <typename T>
+  static void ReserveFor(entityx::Entity entity, std::size_t count) {
+    const auto index = entity.id().index();
+    const void *component = entity.component<T>().get();
+    for (auto pool : GetEntry<T>().pools) {
+      if (index < pool->size() && pool->get(index) == component) {
+        pool->reserve(count);
+        return;
+      }
+    }
+  }
+
+  static void GetStats(std::vector<ComponentPoolStats> &out);
+
+  static std::size_t GetTotalBytes();
+
+  static const std::vector<Entry *> &GetEntries() { return Entries(); }
+
+private:
+  static std::vector<Entry *> &Entries();
+};
+
+/**
+ * Keeps the live count and the high-water mark of every registered component
+ * type up to date for the entities of one event manager.
+ */
+class ComponentPoolTracker {
+public:
+  explicit ComponentPoolTracker(entityx::EventManager &events);
+
+private:
+  std::vector<std::unique_ptr<entityx::BaseReceiver>> mCounters;
+};
+
+template <typename T>
+class ComponentCounter : public entityx::Receiver<ComponentCounter<T>> {
+public:
+  explicit ComponentCounter(entityx::EventManager &events)
+      : mEntry(ComponentPools::GetEntry<T>()) {
+    events.subscribe<entityx::ComponentAddedEvent<T>>(*this);
+    events.subscribe<entityx::ComponentRemovedEvent<T>>(*this);
+  }
+
+  void receive(const entityx::ComponentAddedEvent<T> &event) {
+    FrameCounters::Add(COUNTER_COMPONENTS_ASSIGNED);
+    mEntry.live++;
+    mEntry.highWaterMark = std::max(mEntry.highWaterMark, mEntry.live);
+  }
+
+  void receive(const entityx::ComponentRemovedEvent<T> &event) {
+    if (mEntry.live > 0) {
+      mEntry.live--;
+    }
+  }
+
+private:
+  ComponentPools::Entry &mEntry;
+};
+
+/**
+ * entityx pool that honours the block size, alignment and initial capacity
+ * declared for `T` through COMPONENT_POOL.
+ */
+template <typename T> class ConfiguredPool : public entityx::BasePool {
+  using Traits = ComponentPoolTraits<T>;
+
+public:
+  static_assert(Traits::ALIGNMENT >= alignof(T),
+                "Pool alignment is smaller than the component's alignment");
+  static_assert((Traits::ALIGNMENT & (Traits::ALIGNMENT - 1)) == 0,
+                "Pool alignment must be a power of two");
+  static_assert(Traits::ALIGNMENT <= alignof(std::max_align_t),
+                "entityx allocates blocks with 'new char[]', which cannot "
+                "guarantee over-aligned storage");
+  static_assert(Traits::BLOCK_SIZE > 0, "Pool block size cannot be 0");
+
+  static constexpr std::size_t ELEMENT_SIZE =
+      (sizeof(T) + Traits::ALIGNMENT - 1) / Traits::ALIGNMENT *
+      Traits::ALIGNMENT;
+
+  ConfiguredPool() : entityx::BasePool(ELEMENT_SIZE, Traits::BLOCK_SIZE) {
+    auto &entry = ComponentPools::GetEntry<T>();
+    entry.pools.push_back(this);
+    reserve(std::max(Traits::INITIAL_CAPACITY, entry.reserved));
+  }
+
+  virtual ~ConfiguredPool() {
+    auto &entry = ComponentPools::GetEntry<T>();
+    entry.pools.erase(std::remove(entry.pools.begin(), entry.pools.end(), this),
+                      entry.pools.end());
+    if (entry.pools.empty()) {
+      // Every component dies with its pool
+      entry.live = 0;
+    }
+  }
+
+  virtual void destroy(std::size_t n) override {
+    assert(n < size_);
+    static_cast<T *>(get(n))->~T();
+  }
+};
+
+template <typename T> ComponentPools::Entry &ComponentPools::GetEntry() {
+  using Traits = ComponentPoolTraits<T>;
+  static Entry *entry = [] {
+    auto created = new Entry{Traits::NAME,
+                             ConfiguredPool<T>::ELEMENT_SIZE,
+                             Traits::BLOCK_SIZE,
+                             Traits::ALIGNMENT,
+                             Traits::INITIAL_CAPACITY,
+                             0,
+                             0,
+                             {},
+                             [](entityx::EventManager &events) {
+                               return std::unique_ptr<entityx::BaseReceiver>(
+                                   new ComponentCounter<T>(events));
+                             }};
+    Entries().push_back(created);
+    return created;
+  }();
+  return *entry;
+}
+
+/**
+ * Declares the pool parameters of a component type and makes entityx use them.
+ * This has to be expanded right after the component's definition, in its
+ * header, so that every translation unit sees the same pool type.
+ *
+ * @param Type component type
+ * @param InitialCapacity slots reserved as soon as the pool is created
+ * @param BlockSize slots allocated every time the pool grows
+ * @param Alignment alignment of every slot
+ */
+#define COMPONENT_POOL(Type, InitialCapacity, BlockSize, Alignment)            \
+  template <> struct ComponentPoolTraits<Type> {                               \
+    static constexpr const char *NAME = #Type;                                 \
+    static constexpr std::size_t INITIAL_CAPACITY = InitialCapacity;           \
+    static constexpr std::size_t BLOCK_SIZE = BlockSize;                       \
+    static constexpr std::size_t ALIGNMENT = Alignment;                        \
+  };                                                                           \
+  namespace entityx {                                                          \
+  template <> class Pool<Type> : public ConfiguredPool<Type> {};               \
+  }                                                                            \
+  inline const bool NINPOTEST_POOL_REGISTERED_##Type =                         \
+      ComponentPools::Register<Type>();
+
+#endif // NINPOTEST_COMPONENTPOOL_H
@@ -0,0 +1,405 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_FLATHASHMAP_H
+#define NINPOTEST_FLATHASHMAP_H
+
+#include "Storage.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Default hash of FlatHashMap. Integers and pointers go through a mixing
+ * step: their low bits pick the home slot and are often all zero (aligned
+ * pointers) or sequential (IDs).
+ */
+template <typename Key, typename = void> struct FlatHash : std::hash<Key> {};
+
+template <typename Key>
+struct FlatHash<Key, std::enable_if_t<std::is_integral<Key>::value ||
+                                      std::is_pointer<Key>::value ||
+                                      std::is_enum<Key>::value>> {
+  std::size_t operator()(Key key) const {
+    std::uint64_t value;
+    if constexpr (std::is_pointer<Key>::value) {
+      value = reinterpret_cast<std::uintptr_t>(key);
+    } else {
+      value = static_cast<std::uint64_t>(key);
+    }
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return static_cast<std::size_t>(value);
+  }
+};
+
+namespace internal {
+inline std::string_view AsStringView(std::string_view text) { return text; }
+
+/// Any string class exposing CString() and Length(), e.g. Urho3D::String.
+template <typename S, typename = decltype(std::declval<const S &>().CString())>
+std::string_view AsStringView(const S &text) {
+  return std::string_view(text.CString(), text.Length());
+}
+} // namespace internal
+
+/**
+ * Transparent hash and equality for string keys, so a map keyed by an owning
+ * string can be searched with a literal without building a temporary key.
+ */
+struct StringKeyHash {
+  using is_transparent = void;
+
+  template <typename S> std::size_t operator()(const S &text) const {
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (auto character : internal::AsStringView(text)) {
+      hash ^= static_cast<unsigned char>(character);
+      hash *= 0x100000001b3ULL;
+    }
+    return static_cast<std::size_t>(hash);
+  }
+};
+
+struct StringKeyEqual {
+  using is_transparent = void;
+
+  template <typename A, typename B>
+  bool operator()(const A &left, const B &right) const {
+    return internal::AsStringView(left) == internal::AsStringView(right);
+  }
+};
+
+/**
+ * Open addressing hash map using Robin Hood probing. Entries live in one flat
+ * array next to a byte per slot holding its distance from the home slot, so a
+ * lookup is a short linear scan and inserting only allocates when the table
+ * grows. Erasing shifts the following entries back instead of leaving
+ * tombstones, which keeps probe sequences short under insert/erase churn.
+ *
+ * When both `Hash` and `KeyEqual` declare `is_transparent`, lookups accept
+ * any type they can handle. Iterators and references are invalidated by any
+ * insertion or erasure.
+ */
+template <typename Key, typename Value, typename Hash = FlatHash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+public:
+  using value_type = std::pair<Key, Value>;
+
+  template <bool IsConst> class IteratorBase {
+    using Map = std::conditional_t<IsConst, const FlatHashMap, FlatHashMap>;
+    using Reference = std::conditional_t<IsConst, const value_type &,
+                                         value_type &>;
+
+  public:
+    IteratorBase(Map *map, std::size_t index) : mMap(map), mIndex(index) {
+      SkipEmpty();
+    }
+
+    /// Allows turning an iterator into a const iterator.
+    template <bool OtherConst,
+              typename = std::enable_if_t<IsConst && !OtherConst>>
+    IteratorBase(const IteratorBase<OtherConst> &other)
+        : mMap(other.mMap), mIndex(other.mIndex) {}
+
+    Reference operator*() const { return mMap->mSlots[mIndex].ref(); }
+
+    auto operator->() const { return &mMap->mSlots[mIndex].ref(); }
+
+    IteratorBase &operator++() {
+      ++mIndex;
+      SkipEmpty();
+      return *this;
+    }
+
+    bool operator==(const IteratorBase &other) const {
+      return mIndex == other.mIndex;
+    }
+
+    bool operator!=(const IteratorBase &other) const {
+      return mIndex != other.mIndex;
+    }
+
+  private:
+    friend class FlatHashMap;
+    template <bool> friend class IteratorBase;
+
+    void SkipEmpty() {
+      while (mIndex < mMap->mCapacity && mMap->mDistances[mIndex] == 0) {
+        ++mIndex;
+      }
+    }
+
+    Map *mMap;
+    std::size_t mIndex;
+  };
+
+  using Iterator = IteratorBase<false>;
+  using ConstIterator = IteratorBase<true>;
+
+  FlatHashMap() = default;
+
+  explicit FlatHashMap(std::size_t capacity) { Reserve(capacity); }
+
+  FlatHashMap(FlatHashMap &&other) noexcept { Swap(other); }
+
+  FlatHashMap &operator=(FlatHashMap &&other) noexcept {
+    Swap(other);
+    return *this;
+  }
+
+  FlatHashMap(const FlatHashMap &) = delete;
+  FlatHashMap &operator=(const FlatHashMap &) = delete;
+
+  ~FlatHashMap() { Clear(); }
+
+  Iterator Begin() { return Iterator(this, 0); }
+
+  Iterator End() { return Iterator(this, mCapacity); }
+
+  ConstIterator Begin() const { return ConstIterator(this, 0); }
+
+  ConstIterator End() const { return ConstIterator(this, mCapacity); }
+
+  Iterator begin() { return Begin(); }
+
+  Iterator end() { return End(); }
+
+  ConstIterator begin() const { return Begin(); }
+
+  ConstIterator end() const { return End(); }
+
+  std::size_t Size() const { return mSize; }
+
+  bool Empty() const { return mSize == 0; }
+
+  std::size_t Capacity() const { return mCapacity; }
+
+  template <typename K> Iterator Find(const K &key) {
+    return Iterator(this, FindIndex(key));
+  }
+
+  template <typename K> ConstIterator Find(const K &key) const {
+    return ConstIterator(this, FindIndex(key));
+  }
+
+  template <typename K> bool Contains(const K &key) const {
+    return FindIndex(key) != mCapacity;
+  }
+
+  /**
+   * Inserts `key` with a value built from `args`, unless the key is already
+   * present. Returns the entry and whether it was inserted.
+   */
+  template <typename K, typename... Args>
+  std::pair<Iterator, bool> Emplace(K &&key, Args &&... args) {
+    auto existing = FindIndex(key);
+    if (existing != mCapacity) {
+      return {Iterator(this, existing), false};
+    }
+    if ((mSize + 1) * 5 > mCapacity * 4) {
+      Rehash(mCapacity == 0 ? MIN_CAPACITY : mCapacity * 2);
+    }
+    auto index = InsertNew(
+        value_type(std::piecewise_construct,
+                   std::forward_as_tuple(std::forward<K>(key)),
+                   std::forward_as_tuple(std::forward<Args>(args)...)));
+    return {Iterator(this, index), true};
+  }
+
+  std::pair<Iterator, bool> Insert(const Key &key, const Value &value) {
+    return Emplace(key, value);
+  }
+
+  template <typename K> Value &operator[](K &&key) {
+    return Emplace(std::forward<K>(key)).first->second;
+  }
+
+  template <typename K> bool Erase(const K &key) {
+    auto index = FindIndex(key);
+    if (index == mCapacity) {
+      return false;
+    }
+    EraseIndex(index);
+    return true;
+  }
+
+  /**
+   * Erases the entry at `position` and returns the iterator to the entry that
+   * follows it. Following entries shift back into the freed slot, so an entry
+   * that wrapped around the end of the table may be visited again.
+   */
+  Iterator Erase(Iterator position) {
+    EraseIndex(position.mIndex);
+    return Iterator(this, position.mIndex);
+  }
+
+  Iterator Erase(ConstIterator position) {
+    EraseIndex(position.mIndex);
+    return Iterator(this, position.mIndex);
+  }
+
+  void Clear() {
+    for (std::size_t i = 0; i < mCapacity; ++i) {
+      if (mDistances[i] != 0) {
+        mSlots[i].destroy();
+        mDistances[i] = 0;
+      }
+    }
+    mSize = 0;
+  }
+
+  /// Makes room for `count` entries without growing.
+  void Reserve(std::size_t count) {
+    std::size_t capacity = MIN_CAPACITY;
+    while (capacity * 4 < count * 5) {
+      capacity *= 2;
+    }
+    if (capacity > mCapacity) {
+      Rehash(capacity);
+    }
+  }
+
+  void Swap(FlatHashMap &other) noexcept {
+    std::swap(mDistances, other.mDistances);
+    std::swap(mSlots, other.mSlots);
+    std::swap(mCapacity, other.mCapacity);
+    std::swap(mSize, other.mSize);
+    std::swap(mHash, other.mHash);
+    std::swap(mEqual, other.mEqual);
+  }
+
+private:
+  static constexpr std::size_t MIN_CAPACITY = 16;
+  /// Distances are stored plus one so that zero marks an empty slot.
+  static constexpr std::uint8_t MAX_DISTANCE = 0xff;
+
+  template <typename K> std::size_t FindIndex(const K &key) const {
+    if (mSize == 0) {
+      return mCapacity;
+    }
+    auto mask = mCapacity - 1;
+    auto index = mHash(key) & mask;
+    for (std::uint8_t distance = 1;; ++distance) {
+      // Robin Hood invariant: past an entry closer to its home than we are
+      // to ours, the key cannot be further along
+      if (mDistances[index] < distance) {
+        return mCapacity;
+      }
+      if (mEqual(mSlots[index].ref().first, key)) {
+        return index;
+      }
+      index = (index + 1) & mask;
+    }
+  }
+
+  /**
+   * Places an entry whose key is known to be absent. The entry goes to the
+   * first slot holding an entry closer to its home than this one would be,
+   * and the rest of that run is shifted one slot along.
+   */
+  std::size_t InsertNew(value_type &&entry) {
+    for (;;) {
+      auto mask = mCapacity - 1;
+      auto index = mHash(entry.first) & mask;
+      std::uint8_t distance = 1;
+      while (distance < MAX_DISTANCE && mDistances[index] >= distance) {
+        index = (index + 1) & mask;
+        ++distance;
+      }
+      auto end = index;
+      auto fits = distance < MAX_DISTANCE;
+      while (fits && mDistances[end] != 0) {
+        fits = mDistances[end] + 1 < MAX_DISTANCE;
+        end = (end + 1) & mask;
+      }
+      if (!fits) {
+        // Only a very poor hash gets here; growing spreads the run out
+        Rehash(mCapacity * 2);
+        continue;
+      }
+      while (end != index) {
+        auto previous = (end - 1) & mask;
+        mSlots[end].emplace(std::move(mSlots[previous].ref()));
+        mSlots[previous].destroy();
+        mDistances[end] = mDistances[previous] + 1;
+        end = previous;
+      }
+      mSlots[index].emplace(std::move(entry));
+      mDistances[index] = distance;
+      ++mSize;
+      return index;
+    }
+  }
+
+  void EraseIndex(std::size_t index) {
+    auto mask = mCapacity - 1;
+    mSlots[index].destroy();
+    mDistances[index] = 0;
+    --mSize;
+    auto next = (index + 1) & mask;
+    while (mDistances[next] > 1) {
+      mSlots[index].emplace(std::move(mSlots[next].ref()));
+      mSlots[next].destroy();
+      mDistances[index] = mDistances[next] - 1;
+      mDistances[next] = 0;
+      index = next;
+      next = (next + 1) & mask;
+    }
+  }
+
+  void Rehash(std::size_t capacity) {
+    auto oldDistances = std::move(mDistances);
+    auto oldSlots = std::move(mSlots);
+    auto oldCapacity = mCapacity;
+    mDistances.reset(new std::uint8_t[capacity]());
+    mSlots.reset(new internal::Storage<value_type>[capacity]);
+    mCapacity = capacity;
+    mSize = 0;
+    for (std::size_t i = 0; i < oldCapacity; ++i) {
+      if (oldDistances[i] != 0) {
+        InsertNew(std::move(oldSlots[i].ref()));
+        oldSlots[i].destroy();
+      }
+    }
+  }
+
+  std::unique_ptr<std::uint8_t[]> mDistances;
+  std::unique_ptr<internal::Storage<value_type>[]> mSlots;
+  std::size_t mCapacity = 0;
+  std::size_t mSize = 0;
+  Hash mHash;
+  KeyEqual mEqual;
+};
+
+#endif // NINPOTEST_FLATHASHMAP_H
@@ -0,0 +1,119 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "FrameCounters.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+thread_local FrameCounterBlock *FrameCounters::sBlock = nullptr;
+
+namespace {
+const char *COUNTER_NAMES[NUM_FRAME_COUNTERS] = {
+    "Syncs",          "Urho3D setters",     "Resource lookups",
+    "Instances made", "Entities created",   "Components assigned",
+    "Sound requests", "Sounds culled",      "Sounds finished"};
+
+struct CounterTotals {
+  /// Everything counted up to the end of the last frame.
+  unsigned long long total;
+  unsigned long long lastFrame;
+  unsigned long long sinceReset;
+  unsigned long long peak;
+};
+
+struct CountersState {
+  std::mutex mutex;
+  // NOTE: Blocks outlive their threads, so that what a thread counted is
+  // still added up after it exits
+  std::vector<std::unique_ptr<FrameCounterBlock>> blocks;
+  CounterTotals totals[NUM_FRAME_COUNTERS] = {};
+  unsigned framesSinceReset = 0;
+};
+
+CountersState &GetState() {
+  static CountersState state;
+  return state;
+}
+} // namespace
+
+FrameCounterBlock *FrameCounters::RegisterThread() {
+  // NOTE: Value initialised, so every counter starts at zero
+  auto block = new FrameCounterBlock();
+  auto &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.blocks.emplace_back(block);
+  sBlock = block;
+  return block;
+}
+
+void FrameCounters::EndFrame() {
+  auto &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  ++state.framesSinceReset;
+  for (unsigned i = 0; i < NUM_FRAME_COUNTERS; ++i) {
+    unsigned long long total = 0;
+    for (const auto &block : state.blocks) {
+      total += block->values[i].load(std::memory_order_relaxed);
+    }
+    auto &totals = state.totals[i];
+    totals.lastFrame = total - totals.total;
+    totals.total = total;
+    totals.sinceReset += totals.lastFrame;
+    totals.peak = std::max(totals.peak, totals.lastFrame);
+  }
+}
+
+void FrameCounters::Reset() {
+  auto &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.framesSinceReset = 0;
+  for (auto &totals : state.totals) {
+    totals.sinceReset = 0;
+    totals.peak = 0;
+  }
+}
+
+const char *FrameCounters::GetName(FrameCounter counter) {
+  return COUNTER_NAMES[counter];
+}
+
+FrameCounterStats FrameCounters::GetStats(FrameCounter counter) {
+  auto &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  const auto &totals = state.totals[counter];
+  return FrameCounterStats{
+      COUNTER_NAMES[counter], totals.lastFrame,
+      state.framesSinceReset == 0
+          ? 0.0
+          : static_cast<double>(totals.sinceReset) / state.framesSinceReset,
+      totals.peak};
+}
+
+void FrameCounters::GetStats(std::vector<FrameCounterStats> &stats) {
+  stats.clear();
+  for (unsigned i = 0; i < NUM_FRAME_COUNTERS; ++i) {
+    stats.push_back(GetStats(static_cast<FrameCounter>(i)));
+  }
+}
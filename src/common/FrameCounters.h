@@ -0,0 +1,98 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_FRAMECOUNTERS_H
+#define NINPOTEST_FRAMECOUNTERS_H
+
+#include <atomic>
+#include <vector>
+
+/// Work that is counted on the hot paths.
+enum FrameCounter : unsigned {
+  /// Instances brought up to date with their component.
+  COUNTER_SYNCS,
+  /// Setters called on Urho3D objects while syncing.
+  COUNTER_URHO_SETTERS,
+  COUNTER_RESOURCE_LOOKUPS,
+  COUNTER_INSTANCES_CREATED,
+  COUNTER_ENTITIES_CREATED,
+  /// Components assigned to entities, for types declared with COMPONENT_POOL.
+  COUNTER_COMPONENTS_ASSIGNED,
+  COUNTER_SOUNDS_REQUESTED,
+  /// One-shots dropped for starting out of the listener's range.
+  COUNTER_SOUNDS_CULLED,
+  COUNTER_SOUNDS_FINISHED,
+  NUM_FRAME_COUNTERS
+};
+
+/// What one thread counted so far.
+struct FrameCounterBlock {
+  std::atomic<unsigned long long> values[NUM_FRAME_COUNTERS];
+};
+
+struct FrameCounterStats {
+  const char *name;
+  unsigned long long lastFrame;
+  /// Average per frame since the last reset.
+  double perFrame;
+  /// Most in a single frame since the last reset.
+  unsigned long long peak;
+};
+
+/**
+ * Cheap, always on counters of the work done per frame. Every thread counts
+ * into a block of its own with relaxed stores, the blocks are added up once a
+ * frame by FrameProfiler.
+ *
+ * Like FrameTracer these are process wide, so that counting does not need a
+ * subsystem lookup.
+ */
+class FrameCounters {
+public:
+  static void Add(FrameCounter counter, unsigned long long amount = 1) {
+    auto block = sBlock ? sBlock : RegisterThread();
+    auto &value = block->values[counter];
+    // NOTE: Only this thread writes to its block, no read-modify-write needed
+    value.store(value.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+  }
+
+  /// Adds up what every thread counted during the frame that just ended.
+  static void EndFrame();
+
+  /// Forgets the averages and peaks, e.g. to leave out a warm up.
+  static void Reset();
+
+  static const char *GetName(FrameCounter counter);
+
+  static FrameCounterStats GetStats(FrameCounter counter);
+
+  static void GetStats(std::vector<FrameCounterStats> &stats);
+
+private:
+  static FrameCounterBlock *RegisterThread();
+
+  static thread_local FrameCounterBlock *sBlock;
+};
+
+#endif // NINPOTEST_FRAMECOUNTERS_H
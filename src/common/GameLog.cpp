@@ -0,0 +1,58 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "GameLog.h"
+
+#include <Urho3D/Core/Timer.h>
+
+Urho3D::WeakPtr<Urho3D::Log> GameLog::sLog;
+
+void GameLog::Attach(Urho3D::Log *log) { sLog = log; }
+
+void GameLog::WriteSuppressed(int level, unsigned suppressed) {
+  if (suppressed > 0) {
+    Urho3D::Log::WriteFormat(level, "(%u more like it were left out)",
+                             suppressed);
+  }
+}
+
+LogRateLimit::LogRateLimit(unsigned intervalMs)
+    : mIntervalMs(intervalMs), mLastTime(0), mSuppressed(0),
+      mHasLogged(false) {}
+
+bool LogRateLimit::Allow() {
+  auto now = Urho3D::Time::GetSystemTime();
+  if (mHasLogged && now - mLastTime < mIntervalMs) {
+    ++mSuppressed;
+    return false;
+  }
+  mHasLogged = true;
+  mLastTime = now;
+  return true;
+}
+
+unsigned LogRateLimit::TakeSuppressed() {
+  auto suppressed = mSuppressed;
+  mSuppressed = 0;
+  return suppressed;
+}
@@ -0,0 +1,123 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_GAMELOG_H
+#define NINPOTEST_GAMELOG_H
+
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/IO/Log.h>
+
+/**
+ * Messages below this level are compiled out. Debug messages only make it
+ * into debug builds unless this is defined otherwise.
+ */
+#ifndef GAME_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define GAME_LOG_MIN_LEVEL Urho3D::LOG_INFO
+#else
+#define GAME_LOG_MIN_LEVEL Urho3D::LOG_DEBUG
+#endif
+#endif
+
+/**
+ * Level checks in front of Urho3D's log. Unlike the URHO3D_LOG macros, the
+ * GAME_LOG macros below only evaluate their arguments when the message is
+ * written, so formatting e.g. an entity name costs nothing while the level
+ * filters it out.
+ */
+class GameLog {
+public:
+  /// Follows the level of `log` from now on.
+  static void Attach(Urho3D::Log *log);
+
+  static bool IsEnabled(int level) {
+    if (level < GAME_LOG_MIN_LEVEL) {
+      return false;
+    }
+    // NOTE: Without a log to follow, Urho3D filters the message itself
+    auto log = sLog.Get();
+    return log == nullptr || level >= log->GetLevel();
+  }
+
+  /// Tells how many messages were left out before the one just written.
+  static void WriteSuppressed(int level, unsigned suppressed);
+
+private:
+  static Urho3D::WeakPtr<Urho3D::Log> sLog;
+};
+
+/**
+ * Lets a message through at most once per interval, counting the ones held
+ * back. Meant for errors that would otherwise repeat every frame.
+ *
+ * NOTE: Not thread safe, like the main thread code that logs through it.
+ */
+class LogRateLimit {
+public:
+  static constexpr unsigned DEFAULT_INTERVAL_MS = 1000;
+
+  explicit LogRateLimit(unsigned intervalMs = DEFAULT_INTERVAL_MS);
+
+  /// Whether a message may be written now, otherwise it is counted.
+  bool Allow();
+
+  /// Messages held back since the last one let through.
+  unsigned TakeSuppressed();
+
+private:
+  unsigned mIntervalMs;
+  unsigned mLastTime;
+  unsigned mSuppressed;
+  bool mHasLogged;
+};
+
+#ifdef URHO3D_LOGGING
+#define GAME_LOGF(level, ...)                                                  \
+  do {                                                                         \
+    if (GameLog::IsEnabled(level)) {                                           \
+      Urho3D::Log::WriteFormat(level, __VA_ARGS__);                            \
+    }                                                                          \
+  } while (false)
+
+/// Like GAME_LOGF, but written at most once a second from this call site.
+#define GAME_LOGF_LIMITED(level, ...)                                          \
+  do {                                                                         \
+    static LogRateLimit gameLogRateLimit;                                      \
+    if (GameLog::IsEnabled(level) && gameLogRateLimit.Allow()) {               \
+      Urho3D::Log::WriteFormat(level, __VA_ARGS__);                            \
+      GameLog::WriteSuppressed(level, gameLogRateLimit.TakeSuppressed());      \
+    }                                                                          \
+  } while (false)
+#else
+#define GAME_LOGF(level, ...) ((void)0)
+#define GAME_LOGF_LIMITED(level, ...) ((void)0)
+#endif
+
+#define GAME_LOGDEBUGF(...) GAME_LOGF(Urho3D::LOG_DEBUG, __VA_ARGS__)
+#define GAME_LOGINFOF(...) GAME_LOGF(Urho3D::LOG_INFO, __VA_ARGS__)
+#define GAME_LOGWARNINGF(...) GAME_LOGF(Urho3D::LOG_WARNING, __VA_ARGS__)
+#define GAME_LOGERRORF(...) GAME_LOGF(Urho3D::LOG_ERROR, __VA_ARGS__)
+#define GAME_LOGERRORF_LIMITED(...)                                            \
+  GAME_LOGF_LIMITED(Urho3D::LOG_ERROR, __VA_ARGS__)
+
+#endif // NINPOTEST_GAMELOG_H
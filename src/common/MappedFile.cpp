@@ -0,0 +1,130 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "MappedFile.h"
+
+#include <cstdio>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+MappedFile::MappedFile()
+    : mData(nullptr), mSize(0), mIsMapped(false)
+#if defined(_WIN32)
+      ,
+      mMapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const char *path) {
+  Close();
+#if defined(__linux__) || defined(__APPLE__)
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      auto size = static_cast<std::size_t>(info.st_size);
+      void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        // The file is read front to back
+        madvise(data, size, MADV_SEQUENTIAL);
+        mData = static_cast<const unsigned char *>(data);
+        mSize = size;
+        mIsMapped = true;
+      }
+    }
+    // NOTE: The mapping stays valid after the descriptor is closed
+    close(fd);
+  }
+#elif defined(_WIN32)
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping) {
+        void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data) {
+          mData = static_cast<const unsigned char *>(data);
+          mSize = static_cast<std::size_t>(size.QuadPart);
+          mIsMapped = true;
+          mMapping = mapping;
+        } else {
+          CloseHandle(mapping);
+        }
+      }
+    }
+    CloseHandle(file);
+  }
+#endif
+  if (mIsMapped) {
+    return true;
+  }
+
+  auto file = std::fopen(path, "rb");
+  if (!file) {
+    return false;
+  }
+  std::fseek(file, 0, SEEK_END);
+  auto size = std::ftell(file);
+  std::fseek(file, 0, SEEK_SET);
+  if (size > 0) {
+    mBuffer.resize(static_cast<std::size_t>(size));
+    if (std::fread(mBuffer.data(), 1, mBuffer.size(), file) == mBuffer.size()) {
+      mData = mBuffer.data();
+      mSize = mBuffer.size();
+    }
+  }
+  std::fclose(file);
+  if (!mData) {
+    mBuffer = std::vector<unsigned char>();
+  }
+  return mData != nullptr;
+}
+
+void MappedFile::Close() {
+  if (mIsMapped) {
+#if defined(__linux__) || defined(__APPLE__)
+    munmap(const_cast<unsigned char *>(mData), mSize);
+#elif defined(_WIN32)
+    UnmapViewOfFile(mData);
+    CloseHandle(mMapping);
+    mMapping = nullptr;
+#endif
+  }
+  mBuffer = std::vector<unsigned char>();
+  mData = nullptr;
+  mSize = 0;
+  mIsMapped = false;
+}
@@ -0,0 +1,64 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_MAPPEDFILE_H
+#define NINPOTEST_MAPPEDFILE_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Read only view of a whole file, mapped into memory where the platform
+ * supports it and read into a buffer otherwise. The pages are only loaded
+ * once they are touched.
+ */
+class MappedFile {
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool Open(const char *path);
+
+  void Close();
+
+  bool IsOpen() const { return mData != nullptr; }
+
+  const unsigned char *GetData() const { return mData; }
+
+  std::size_t GetSize() const { return mSize; }
+
+private:
+  const unsigned char *mData;
+  std::size_t mSize;
+  bool mIsMapped;
+  // NOTE: Only used when the file could not be mapped
+  std::vector<unsigned char> mBuffer;
+#if defined(_WIN32)
+  void *mMapping;
+#endif
+};
+
+#endif // NINPOTEST_MAPPEDFILE_H
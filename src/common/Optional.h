@@ -27,159 +27,244 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "None.h"
 #include "Storage.h"
 
-#include <functional>
-#include <stdexcept>
+#include <exception>
+#include <type_traits>
 #include <utility>
 
-template <typename T> class Optional {
-public:
-  Optional();
-  explicit Optional(const None &none);
-  explicit Optional(const T &val);
-  explicit Optional(T &&val) noexcept;
+namespace internal {
+template <typename Self, typename... Args> struct IsSelfArgument {
+  static constexpr bool value = false;
+};
 
-  Optional(const Optional &) = default;
-  Optional(Optional &&) noexcept = default;
+template <typename Self, typename First>
+struct IsSelfArgument<Self, First> {
+  static constexpr bool value = std::is_same<std::decay_t<First>, Self>::value;
+};
+
+/**
+ * Holds the value and the initialized flag of an Optional and implements its
+ * copy and move semantics. Values that are not trivially copyable are copied,
+ * moved and destroyed only when they are actually present.
+ */
+template <typename T, bool = std::is_trivially_copyable<T>::value>
+class OptionalBase {
+protected:
+  constexpr OptionalBase() noexcept : mStorage(), mInitialized(false) {}
 
   template <typename... Args>
-  explicit Optional(Args &&... args) : mInitialized(false) {
-    assign(std::move(args)...);
-  }
+  constexpr explicit OptionalBase(InPlace tag, Args &&... args)
+      : mStorage(tag, std::forward<Args>(args)...), mInitialized(true) {}
 
-  ~Optional();
+  OptionalBase(const OptionalBase &other) : mStorage(), mInitialized(false) {
+    if (other.mInitialized) {
+      construct(other.mStorage.ref());
+    }
+  }
 
-  explicit operator bool() const { return mInitialized; }
+  OptionalBase(OptionalBase &&other) noexcept(
+      std::is_nothrow_move_constructible<T>::value)
+      : mStorage(), mInitialized(false) {
+    if (other.mInitialized) {
+      construct(std::move(other.mStorage.ref()));
+    }
+  }
 
-  T &operator*() { return value(); }
+  OptionalBase &operator=(const OptionalBase &other) {
+    if (other.mInitialized) {
+      assignValue(other.mStorage.ref());
+    } else {
+      reset();
+    }
+    return *this;
+  }
 
-  const T &operator*() const { return value(); }
+  OptionalBase &operator=(OptionalBase &&other) noexcept(
+      std::is_nothrow_move_constructible<T>::value
+          &&std::is_nothrow_move_assignable<T>::value) {
+    if (other.mInitialized) {
+      assignValue(std::move(other.mStorage.ref()));
+    } else {
+      reset();
+    }
+    return *this;
+  }
 
-  T &value() { return mStorage.ref(); }
+  ~OptionalBase() { reset(); }
 
-  const T &value() const { return mStorage.ref(); }
+  template <typename... Args> void construct(Args &&... args) {
+    mStorage.emplace(std::forward<Args>(args)...);
+    mInitialized = true;
+  }
 
-  template <typename... Args> void emplace(Args &&... args) {
-    assign(std::move(args)...);
+  template <typename U> void assignValue(U &&value) {
+    if (mInitialized) {
+      mStorage.ref() = std::forward<U>(value);
+    } else {
+      construct(std::forward<U>(value));
+    }
   }
 
-  Optional &operator=(const None &none) {
-    mInitialized = false;
-    return *this;
+  void reset() {
+    if (mInitialized) {
+      mStorage.destroy();
+      mInitialized = false;
+    }
   }
 
-  Optional &operator=(const T &val) {
-    assign(val);
-    return *this;
+  Storage<T> mStorage;
+  bool mInitialized;
+};
+
+/**
+ * Trivially copyable values keep every special member defaulted, so the
+ * Optional itself stays trivially copyable and usable in constant expressions.
+ */
+template <typename T> class OptionalBase<T, true> {
+protected:
+  constexpr OptionalBase() noexcept : mStorage(), mInitialized(false) {}
+
+  template <typename... Args>
+  constexpr explicit OptionalBase(InPlace tag, Args &&... args)
+      : mStorage(tag, std::forward<Args>(args)...), mInitialized(true) {}
+
+  template <typename... Args> void construct(Args &&... args) {
+    mStorage.emplace(std::forward<Args>(args)...);
+    mInitialized = true;
   }
 
-  Optional &operator=(T &&val) {
-    assign(std::move(val));
-    return *this;
+  template <typename U> void assignValue(U &&value) {
+    construct(std::forward<U>(value));
   }
 
-  Optional &operator=(const Optional &) = default;
+  void reset() { mInitialized = false; }
 
-  Optional &operator=(Optional &&) = default;
+  Storage<T> mStorage;
+  bool mInitialized;
+};
+} // namespace internal
 
-  bool isInitialized() const { return mInitialized; }
+template <typename T> class Optional : private internal::OptionalBase<T> {
+  using Base = internal::OptionalBase<T>;
 
-  T value_or(T defaultValue);
+  template <typename... Args>
+  using EnableIfConstructible = std::enable_if_t<
+      std::is_constructible<T, Args...>::value &&
+      !internal::IsSelfArgument<Optional, Args...>::value &&
+      !internal::IsSelfArgument<None, Args...>::value>;
 
-  T value_or(T defaultValue) const;
+public:
+  constexpr Optional() noexcept = default;
 
-  T value_or_eval(std::function<T()> valueRetriever);
+  constexpr explicit Optional(const None &) noexcept : Base() {}
 
-  T value_or_eval(std::function<T()> valueRetriever) const;
+  constexpr explicit Optional(const T &val) : Base(internal::InPlace(), val) {}
 
-  template <typename ExceptionType, typename = std::enable_if<std::is_base_of<
-                                        std::exception, ExceptionType>::value>>
-  T value_or_throw(std::function<ExceptionType()> exceptionSupplier) {
-    if (!mInitialized) {
-      throw exceptionSupplier();
-    }
-    return value();
-  }
+  constexpr explicit Optional(T &&val) noexcept(
+      std::is_nothrow_move_constructible<T>::value)
+      : Base(internal::InPlace(), std::move(val)) {}
 
-  template <typename ExceptionType, typename = std::enable_if<std::is_base_of<
-                                        std::exception, ExceptionType>::value>>
-  T value_or_throw(std::function<ExceptionType()> exceptionSupplier) const {
-    if (!mInitialized) {
-      throw exceptionSupplier();
-    }
-    return value();
+  template <typename... Args, typename = EnableIfConstructible<Args...>>
+  constexpr explicit Optional(Args &&... args)
+      : Base(internal::InPlace(), std::forward<Args>(args)...) {}
+
+  Optional(const Optional &) = default;
+
+  Optional(Optional &&) = default;
+
+  constexpr explicit operator bool() const noexcept {
+    return this->mInitialized;
   }
 
-  static Optional<T> empty() { return Optional<T>(None::Instance); }
+  constexpr T &operator*() { return value(); }
 
-private:
-  void assign(const T &val);
+  constexpr const T &operator*() const { return value(); }
 
-  void assign(T &&val);
+  T *operator->() { return this->mStorage.ptr(); }
 
-  template <typename... Args> void assign(Args &&... args) {
-    destroy();
-    mStorage.emplace(std::move(args)...);
-    mInitialized = true;
+  const T *operator->() const { return this->mStorage.ptr(); }
+
+  constexpr T &value() { return this->mStorage.ref(); }
+
+  constexpr const T &value() const { return this->mStorage.ref(); }
+
+  template <typename... Args> void emplace(Args &&... args) {
+    this->reset();
+    this->construct(std::forward<Args>(args)...);
   }
 
-  void destroy() {
-    if (!mInitialized) {
-      return;
-    }
-    mStorage.destroy();
-    mInitialized = false;
+  void reset() { Base::reset(); }
+
+  Optional &operator=(const None &) {
+    this->reset();
+    return *this;
   }
 
-private:
-  bool mInitialized;
-  internal::Storage<T> mStorage;
-};
+  Optional &operator=(const T &val) {
+    this->assignValue(val);
+    return *this;
+  }
+
+  Optional &operator=(T &&val) {
+    this->assignValue(std::move(val));
+    return *this;
+  }
 
-template <typename T> Optional<T>::Optional() : mInitialized(false) {}
+  Optional &operator=(const Optional &) = default;
 
-template <typename T>
-Optional<T>::Optional(const None &none) : mInitialized(false) {}
+  Optional &operator=(Optional &&) = default;
 
-template <typename T>
-Optional<T>::Optional(const T &val) : mInitialized(false) {
-  assign(val);
-}
+  constexpr bool isInitialized() const noexcept { return this->mInitialized; }
 
-template <typename T>
-Optional<T>::Optional(T &&val) noexcept : mInitialized(false) {
-  assign(std::forward<T>(val));
-}
+  template <typename U> constexpr T value_or(U &&defaultValue) const & {
+    return this->mInitialized ? value()
+                              : static_cast<T>(std::forward<U>(defaultValue));
+  }
 
-template <typename T> Optional<T>::~Optional() { destroy(); }
+  template <typename U> constexpr T value_or(U &&defaultValue) && {
+    return this->mInitialized ? std::move(value())
+                              : static_cast<T>(std::forward<U>(defaultValue));
+  }
 
-template <typename T> T Optional<T>::value_or(T defaultValue) {
-  return mInitialized ? value() : defaultValue;
-}
+  /**
+   * The retriever and supplier below are taken as plain callables rather than
+   * std::function so they are inlined at the call site and never allocate,
+   * whatever the lambda captures.
+   */
+  template <typename F> T value_or_eval(F &&valueRetriever) const & {
+    return this->mInitialized
+               ? value()
+               : static_cast<T>(std::forward<F>(valueRetriever)());
+  }
 
-template <typename T> T Optional<T>::value_or(T defaultValue) const {
-  return mInitialized ? value() : defaultValue;
-}
+  template <typename F> T value_or_eval(F &&valueRetriever) && {
+    return this->mInitialized
+               ? std::move(value())
+               : static_cast<T>(std::forward<F>(valueRetriever)());
+  }
 
-template <typename T>
-T Optional<T>::value_or_eval(std::function<T()> valueRetriever) {
-  return mInitialized ? value() : valueRetriever();
-}
+  template <typename F>
+  const T &value_or_throw(F &&exceptionSupplier) const & {
+    ThrowIfEmpty(std::forward<F>(exceptionSupplier));
+    return value();
+  }
 
-template <typename T>
-T Optional<T>::value_or_eval(std::function<T()> valueRetriever) const {
-  return mInitialized ? value() : valueRetriever();
-}
+  /// Returns by value, a reference into a temporary would dangle.
+  template <typename F> T value_or_throw(F &&exceptionSupplier) && {
+    ThrowIfEmpty(std::forward<F>(exceptionSupplier));
+    return std::move(value());
+  }
 
-template <typename T> void Optional<T>::assign(const T &val) {
-  destroy();
-  mStorage.assign(val);
-  mInitialized = true;
-}
+  static constexpr Optional<T> empty() noexcept { return Optional<T>(); }
 
-template <typename T> void Optional<T>::assign(T &&val) {
-  destroy();
-  mStorage.assign(std::move(val));
-  mInitialized = true;
-}
+private:
+  template <typename F> void ThrowIfEmpty(F &&exceptionSupplier) const {
+    using ExceptionType = std::decay_t<decltype(exceptionSupplier())>;
+    static_assert(std::is_base_of<std::exception, ExceptionType>::value,
+                  "value_or_throw expects a supplier of std::exception");
+    if (!this->mInitialized) {
+      throw std::forward<F>(exceptionSupplier)();
+    }
+  }
+};
 
 #endif // NINPOTEST_OPTIONAL_H
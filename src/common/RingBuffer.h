@@ -0,0 +1,297 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_RINGBUFFER_H
+#define NINPOTEST_RINGBUFFER_H
+
+#include "Storage.h"
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/// Assumed size of a cache line. Shared indices are padded to it so that the
+/// producer and consumer sides never write to the same line.
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+namespace internal {
+constexpr bool IsPowerOfTwo(std::size_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+} // namespace internal
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer
+ * thread. Each side keeps a cached copy of the other side's index and only
+ * reloads it when the ring looks full (or empty), so in the common case a push
+ * or pop touches no shared cache line besides the slot itself.
+ */
+template <typename T, std::size_t Capacity> class SpscRing {
+  static_assert(internal::IsPowerOfTwo(Capacity),
+                "SpscRing capacity must be a power of two");
+
+public:
+  SpscRing() = default;
+
+  ~SpscRing() {
+    auto tail = mProducer.index.load(std::memory_order_acquire);
+    for (auto head = mConsumer.index.load(std::memory_order_relaxed);
+         head != tail; ++head) {
+      mSlots[head & MASK].destroy();
+    }
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  bool TryPush(const T &value) { return TryEmplace(value); }
+
+  bool TryPush(T &&value) { return TryEmplace(std::move(value)); }
+
+  template <typename... Args> bool TryEmplace(Args &&... args) {
+    auto tail = mProducer.index.load(std::memory_order_relaxed);
+    if (tail - mProducer.cachedOther == Capacity) {
+      mProducer.cachedOther = mConsumer.index.load(std::memory_order_acquire);
+      if (tail - mProducer.cachedOther == Capacity) {
+        return false;
+      }
+    }
+    mSlots[tail & MASK].emplace(std::forward<Args>(args)...);
+    mProducer.index.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Moves as many of the `count` values starting at `first` as fit and
+   * publishes them at once. Returns how many were pushed.
+   */
+  template <typename InputIt>
+  std::size_t PushBatch(InputIt first, std::size_t count) {
+    auto tail = mProducer.index.load(std::memory_order_relaxed);
+    auto space = Capacity - (tail - mProducer.cachedOther);
+    if (space < count) {
+      mProducer.cachedOther = mConsumer.index.load(std::memory_order_acquire);
+      space = Capacity - (tail - mProducer.cachedOther);
+    }
+    auto pushed = count < space ? count : space;
+    for (std::size_t i = 0; i < pushed; ++i, ++first) {
+      mSlots[(tail + i) & MASK].emplace(std::move(*first));
+    }
+    mProducer.index.store(tail + pushed, std::memory_order_release);
+    return pushed;
+  }
+
+  bool TryPop(T &out) {
+    auto head = mConsumer.index.load(std::memory_order_relaxed);
+    if (head == mConsumer.cachedOther) {
+      mConsumer.cachedOther = mProducer.index.load(std::memory_order_acquire);
+      if (head == mConsumer.cachedOther) {
+        return false;
+      }
+    }
+    auto &slot = mSlots[head & MASK];
+    out = std::move(slot.ref());
+    slot.destroy();
+    mConsumer.index.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Pops up to `maxCount` values into `out` and releases their slots at once.
+   * Returns how many were popped.
+   */
+  template <typename OutputIt>
+  std::size_t PopBatch(OutputIt out, std::size_t maxCount) {
+    auto head = mConsumer.index.load(std::memory_order_relaxed);
+    auto available = mConsumer.cachedOther - head;
+    if (available < maxCount) {
+      mConsumer.cachedOther = mProducer.index.load(std::memory_order_acquire);
+      available = mConsumer.cachedOther - head;
+    }
+    auto popped = maxCount < available ? maxCount : available;
+    for (std::size_t i = 0; i < popped; ++i, ++out) {
+      auto &slot = mSlots[(head + i) & MASK];
+      *out = std::move(slot.ref());
+      slot.destroy();
+    }
+    mConsumer.index.store(head + popped, std::memory_order_release);
+    return popped;
+  }
+
+  /// Approximate when called while the other side is running.
+  std::size_t Size() const {
+    return mProducer.index.load(std::memory_order_acquire) -
+           mConsumer.index.load(std::memory_order_acquire);
+  }
+
+  static constexpr std::size_t GetCapacity() { return Capacity; }
+
+private:
+  static constexpr std::size_t MASK = Capacity - 1;
+
+  struct alignas(CACHE_LINE_SIZE) Side {
+    std::atomic<std::size_t> index{0};
+    /// Last seen index of the other side, only touched by this side.
+    std::size_t cachedOther = 0;
+  };
+
+  Side mProducer;
+  Side mConsumer;
+  alignas(CACHE_LINE_SIZE) internal::Storage<T> mSlots[Capacity];
+};
+
+/**
+ * Bounded lock-free queue for any number of producer threads and a single
+ * consumer, e.g. worker jobs handing results back to the main thread. Every
+ * slot carries a sequence number telling whether it is free for the current
+ * lap or holds a published value, so producers only contend on the enqueue
+ * index and the consumer needs no atomic read-modify-write at all.
+ */
+template <typename T, std::size_t Capacity> class MpscRing {
+  static_assert(internal::IsPowerOfTwo(Capacity),
+                "MpscRing capacity must be a power of two");
+
+public:
+  MpscRing() {
+    for (std::size_t i = 0; i < Capacity; ++i) {
+      mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~MpscRing() {
+    while (Consume([](T &) {})) {
+    }
+  }
+
+  MpscRing(const MpscRing &) = delete;
+  MpscRing &operator=(const MpscRing &) = delete;
+
+  bool TryPush(const T &value) { return TryEmplace(value); }
+
+  bool TryPush(T &&value) { return TryEmplace(std::move(value)); }
+
+  template <typename... Args> bool TryEmplace(Args &&... args) {
+    std::size_t position;
+    if (!Claim(1, position)) {
+      return false;
+    }
+    auto &slot = mSlots[position & MASK];
+    slot.value.emplace(std::forward<Args>(args)...);
+    slot.sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Claims room for all `count` values in one step, or for none of them.
+   * Returns how many were pushed.
+   */
+  template <typename InputIt>
+  std::size_t PushBatch(InputIt first, std::size_t count) {
+    if (count == 0 || count > Capacity) {
+      return 0;
+    }
+    std::size_t position;
+    if (!Claim(count, position)) {
+      return 0;
+    }
+    for (std::size_t i = 0; i < count; ++i, ++first) {
+      auto &slot = mSlots[(position + i) & MASK];
+      slot.value.emplace(std::move(*first));
+      slot.sequence.store(position + i + 1, std::memory_order_release);
+    }
+    return count;
+  }
+
+  /// Must only be called from the consumer thread.
+  bool TryPop(T &out) {
+    return Consume([&out](T &value) { out = std::move(value); });
+  }
+
+  /// Must only be called from the consumer thread.
+  template <typename OutputIt>
+  std::size_t PopBatch(OutputIt out, std::size_t maxCount) {
+    std::size_t popped = 0;
+    while (popped < maxCount && Consume([&out](T &value) {
+             *out = std::move(value);
+             ++out;
+           })) {
+      ++popped;
+    }
+    return popped;
+  }
+
+  static constexpr std::size_t GetCapacity() { return Capacity; }
+
+private:
+  static constexpr std::size_t MASK = Capacity - 1;
+
+  struct alignas(CACHE_LINE_SIZE) Slot {
+    std::atomic<std::size_t> sequence;
+    internal::Storage<T> value;
+  };
+
+  template <typename F> bool Consume(F &&consumer) {
+    auto &slot = mSlots[mDequeuePosition & MASK];
+    if (slot.sequence.load(std::memory_order_acquire) !=
+        mDequeuePosition + 1) {
+      return false;
+    }
+    consumer(slot.value.ref());
+    slot.value.destroy();
+    slot.sequence.store(mDequeuePosition + Capacity,
+                        std::memory_order_release);
+    ++mDequeuePosition;
+    return true;
+  }
+
+  /**
+   * Reserves `count` consecutive slots. The consumer frees slots in order, so
+   * when the last one is free for this lap all of them are.
+   */
+  bool Claim(std::size_t count, std::size_t &position) {
+    position = mEnqueuePosition.load(std::memory_order_relaxed);
+    for (;;) {
+      auto &last = mSlots[(position + count - 1) & MASK];
+      auto sequence = last.sequence.load(std::memory_order_acquire);
+      auto difference = static_cast<std::ptrdiff_t>(sequence) -
+                        static_cast<std::ptrdiff_t>(position + count - 1);
+      if (difference == 0) {
+        if (mEnqueuePosition.compare_exchange_weak(
+                position, position + count, std::memory_order_relaxed)) {
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = mEnqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mEnqueuePosition{0};
+  alignas(CACHE_LINE_SIZE) std::size_t mDequeuePosition = 0;
+  Slot mSlots[Capacity];
+};
+
+#endif // NINPOTEST_RINGBUFFER_H
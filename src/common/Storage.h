@@ -24,43 +24,104 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_STORAGE_H
 #define NINPOTEST_STORAGE_H
 
-#include <cstring>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 namespace internal {
-template <typename T, size_t Size = sizeof(T)> class Storage {
+/**
+ * Tag used to construct the stored value in place.
+ */
+struct InPlace {
+  explicit InPlace() = default;
+};
+
+/**
+ * Uninitialized storage for a `T`. Whether it holds a live value is tracked by
+ * the owner, which is also responsible for copying, moving and destroying it.
+ * Because of that this version, used for types that are not trivially
+ * copyable, cannot be copied at all.
+ */
+template <typename T, bool = std::is_trivially_copyable<T>::value>
+class Storage {
 public:
-  Storage() = default;
-  Storage(const Storage &) = default;
-  Storage(Storage &&) noexcept = default;
+  constexpr Storage() noexcept : mEmpty() {}
+
+  template <typename... Args>
+  constexpr explicit Storage(InPlace, Args &&... args)
+      : mValue(std::forward<Args>(args)...) {}
+
+  Storage(const Storage &) = delete;
+  Storage &operator=(const Storage &) = delete;
+
+  ~Storage() {}
 
-  void assign(const T &value) { ::new (&mData[0]) T(value); }
+  void assign(const T &value) { emplace(value); }
 
-  void assign(T &&value) { ::new (&mData[0]) T(std::move(value)); }
+  void assign(T &&value) { emplace(std::move(value)); }
 
-  template <typename... Args> void emplace(Args... args) {
-    ::new (&mData[0]) T(std::move(args)...);
+  template <typename... Args> void emplace(Args &&... args) {
+    ::new (static_cast<void *>(ptr())) T(std::forward<Args>(args)...);
   }
 
-  Storage &operator=(const Storage &other) {
-    std::memcpy(mData, other.mData, sizeof(T));
-    return *this;
+  constexpr std::size_t size() const { return sizeof(T); }
+
+  T *ptr() { return std::addressof(mValue); }
+
+  const T *ptr() const { return std::addressof(mValue); }
+
+  constexpr T &ref() { return mValue; }
+
+  constexpr const T &ref() const { return mValue; }
+
+  void destroy() { mValue.~T(); }
+
+private:
+  union {
+    char mEmpty;
+    T mValue;
+  };
+};
+
+/**
+ * Trivially copyable types keep the default copy and move operations, which
+ * compile down to a memcpy, and have nothing to destroy.
+ */
+template <typename T> class Storage<T, true> {
+public:
+  constexpr Storage() noexcept : mEmpty() {}
+
+  template <typename... Args>
+  constexpr explicit Storage(InPlace, Args &&... args)
+      : mValue(std::forward<Args>(args)...) {}
+
+  void assign(const T &value) { emplace(value); }
+
+  void assign(T &&value) { emplace(std::move(value)); }
+
+  template <typename... Args> void emplace(Args &&... args) {
+    ::new (static_cast<void *>(ptr())) T(std::forward<Args>(args)...);
   }
 
-  constexpr size_t size() const { return Size; }
+  constexpr std::size_t size() const { return sizeof(T); }
 
-  T *ptr() { return static_cast<T *>((void *)mData); }
+  T *ptr() { return std::addressof(mValue); }
 
-  const T *ptr() const { return static_cast<const T *>((const void *)mData); }
+  const T *ptr() const { return std::addressof(mValue); }
 
-  T &ref() { return *ptr(); }
+  constexpr T &ref() { return mValue; }
 
-  const T &ref() const { return *ptr(); }
+  constexpr const T &ref() const { return mValue; }
 
-  void destroy() { ref().T::~T(); }
+  void destroy() {}
 
 private:
-  char mData[Size];
+  union {
+    char mEmpty;
+    T mValue;
+  };
 };
 } // namespace internal
 
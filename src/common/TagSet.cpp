@@ -0,0 +1,166 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "TagSet.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NINPOTEST_TAGSET_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NINPOTEST_TAGSET_NEON
+#endif
+
+std::size_t internal::BaseTag::sFamilyCounter = 0;
+
+void internal::AndWords(uint64_t *dst, const uint64_t *src, std::size_t count) {
+  std::size_t i = 0;
+#if defined(NINPOTEST_TAGSET_SSE2)
+  for (; i + 2 <= count; i += 2) {
+    auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_and_si128(a, b));
+  }
+#elif defined(NINPOTEST_TAGSET_NEON)
+  for (; i + 2 <= count; i += 2) {
+    vst1q_u64(dst + i, vandq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] &= src[i];
+  }
+}
+
+void internal::AndNotWords(uint64_t *dst, const uint64_t *src,
+                           std::size_t count) {
+  std::size_t i = 0;
+#if defined(NINPOTEST_TAGSET_SSE2)
+  for (; i + 2 <= count; i += 2) {
+    auto a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+    auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    // NOTE: andnot complements its first operand
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_andnot_si128(b, a));
+  }
+#elif defined(NINPOTEST_TAGSET_NEON)
+  for (; i + 2 <= count; i += 2) {
+    vst1q_u64(dst + i, vbicq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] &= ~src[i];
+  }
+}
+
+TagSet::TagSet(entityx::EventManager &events) {
+  events.subscribe<entityx::EntityDestroyedEvent>(*this);
+}
+
+void TagSet::receive(const entityx::EntityDestroyedEvent &event) {
+  auto index = event.entity.id().index();
+  for (std::size_t family = 0; family < mColumns.size(); ++family) {
+    ClearBit(family, index);
+  }
+}
+
+void TagSet::SetBit(std::size_t family, std::uint32_t index) {
+  if (mColumns.size() <= family) {
+    mColumns.resize(family + 1);
+  }
+  auto &column = mColumns[family];
+  std::size_t word = index / 64;
+  if (column.size() <= word) {
+    column.resize(word + 1, 0);
+  }
+  column[word] |= uint64_t(1) << (index % 64);
+}
+
+void TagSet::ClearBit(std::size_t family, std::uint32_t index) {
+  if (mColumns.size() <= family) {
+    return;
+  }
+  auto &column = mColumns[family];
+  std::size_t word = index / 64;
+  if (word < column.size()) {
+    column[word] &= ~(uint64_t(1) << (index % 64));
+  }
+}
+
+void TagSet::ClearTag(std::size_t family, std::uint32_t index) {
+  ClearBit(family, index);
+  for (const auto &link : mLinks) {
+    if (link.first == family) {
+      ClearTag(link.second, index);
+    }
+  }
+}
+
+bool TagSet::TestBit(std::size_t family, std::uint32_t index) const {
+  if (mColumns.size() <= family) {
+    return false;
+  }
+  auto &column = mColumns[family];
+  std::size_t word = index / 64;
+  return word < column.size() &&
+         (column[word] & (uint64_t(1) << (index % 64))) != 0;
+}
+
+void TagSet::Select(const std::size_t *families, std::size_t count,
+                    std::vector<uint64_t> &out) const {
+  std::size_t words = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (families[i] >= mColumns.size()) {
+      out.clear();
+      return;
+    }
+    auto size = mColumns[families[i]].size();
+    words = i == 0 ? size : std::min(words, size);
+  }
+  auto &first = mColumns[families[0]];
+  out.assign(first.begin(), first.begin() + words);
+  for (std::size_t i = 1; i < count; ++i) {
+    internal::AndWords(out.data(), mColumns[families[i]].data(), words);
+  }
+}
+
+void TagSet::SelectAll(std::size_t capacity, std::vector<uint64_t> &out) {
+  out.assign((capacity + 63) / 64, ~uint64_t(0));
+  if (capacity % 64 != 0) {
+    out.back() = (uint64_t(1) << (capacity % 64)) - 1;
+  }
+}
+
+void TagSet::Exclude(const std::size_t *families, std::size_t count,
+                     std::vector<uint64_t> &out) const {
+  for (std::size_t i = 0; i < count; ++i) {
+    if (families[i] >= mColumns.size()) {
+      continue;
+    }
+    auto &column = mColumns[families[i]];
+    internal::AndNotWords(out.data(), column.data(),
+                          std::min(out.size(), column.size()));
+  }
+}
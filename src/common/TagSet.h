@@ -0,0 +1,201 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_TAGSET_H
+#define NINPOTEST_TAGSET_H
+
+#include <entityx/Entity.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace internal {
+struct BaseTag {
+  static std::size_t sFamilyCounter;
+};
+
+template <typename T> struct TagFamily {
+  static std::size_t Id() {
+    static const std::size_t id = BaseTag::sFamilyCounter++;
+    return id;
+  }
+};
+
+/**
+ * dst[i] &= src[i] for every word, vectorized where the target allows it.
+ */
+void AndWords(uint64_t *dst, const uint64_t *src, std::size_t count);
+
+/**
+ * dst[i] &= ~src[i] for every word, vectorized where the target allows it.
+ */
+void AndNotWords(uint64_t *dst, const uint64_t *src, std::size_t count);
+
+inline unsigned CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+} // namespace internal
+
+template <typename... Tags> struct TagList {};
+
+/**
+ * Zero-size marker components. Instead of living in an entityx pool, every tag
+ * is a bit column with one bit per entity index, so filtering a world by tags
+ * only reads (and ANDs) 64 entities per word and never touches component data.
+ *
+ * Any empty struct can be used as a tag; it does not need to be registered.
+ */
+class TagSet : public entityx::Receiver<TagSet> {
+public:
+  explicit TagSet(entityx::EventManager &events);
+
+  void receive(const entityx::EntityDestroyedEvent &event);
+
+  template <typename T> void Set(entityx::Entity entity) {
+    SetBit(internal::TagFamily<T>::Id(), entity.id().index());
+  }
+
+  /// Clears the tags linked to `T` as well, see Link.
+  template <typename T> void Clear(entityx::Entity entity) {
+    ClearTag(internal::TagFamily<T>::Id(), entity.id().index());
+  }
+
+  /**
+   * Makes clearing `T` clear `Dependent` too, for a tag that only holds as
+   * long as another one does. Links must not form a cycle.
+   */
+  template <typename T, typename Dependent> void Link() {
+    mLinks.emplace_back(internal::TagFamily<T>::Id(),
+                        internal::TagFamily<Dependent>::Id());
+  }
+
+  template <typename T> bool Has(entityx::Entity entity) const {
+    return TestBit(internal::TagFamily<T>::Id(), entity.id().index());
+  }
+
+  /**
+   * Calls `fn(entity, components...)` for every entity that has all the given
+   * tags and all of `Components`. The tag columns are intersected first, so
+   * component masks are only looked at for entities that passed the filter.
+   *
+   * Tags can be set or cleared from `fn`; the filter is a snapshot taken
+   * before the first call.
+   */
+  template <typename... Components, typename... Tags, typename Fn>
+  void Each(TagList<Tags...>, entityx::EntityManager &entities, Fn &&fn) {
+    static_assert(sizeof...(Tags) > 0, "At least one tag is required");
+    Each<Components...>(TagList<Tags...>(), TagList<>(), entities,
+                        std::forward<Fn>(fn));
+  }
+
+  /**
+   * Same as above, leaving out the entities having any of the `Excluded`
+   * tags. The excluded columns are masked out of the filter word by word, so
+   * only the entities left over are looked at. Without any `Included` tag
+   * every entity index starts out in the filter, and at least one component
+   * is needed to tell live entities apart.
+   */
+  template <typename... Components, typename... Included,
+            typename... Excluded, typename Fn>
+  void Each(TagList<Included...>, TagList<Excluded...>,
+            entityx::EntityManager &entities, Fn &&fn) {
+    static_assert(sizeof...(Included) > 0 || sizeof...(Components) > 0,
+                  "A tag or a component to include is required");
+    const std::array<std::size_t, sizeof...(Included)> included = {
+        {internal::TagFamily<Included>::Id()...}};
+    const std::array<std::size_t, sizeof...(Excluded)> excluded = {
+        {internal::TagFamily<Excluded>::Id()...}};
+    // NOTE: Taking the scratch buffer keeps nested queries from overwriting it
+    std::vector<uint64_t> words;
+    words.swap(mScratch);
+    if (included.empty()) {
+      SelectAll(entities.capacity(), words);
+    } else {
+      Select(included.data(), included.size(), words);
+    }
+    Exclude(excluded.data(), excluded.size(), words);
+    for (std::size_t word = 0; word < words.size(); ++word) {
+      uint64_t bits = words[word];
+      while (bits != 0) {
+        auto index = word * 64 + internal::CountTrailingZeros(bits);
+        bits &= bits - 1;
+        auto entity = entities.get(
+            entities.create_id(static_cast<std::uint32_t>(index)));
+        if ((entity.template has_component<Components>() && ...)) {
+          fn(entity, *entity.template component<Components>()...);
+        }
+      }
+    }
+    words.swap(mScratch);
+  }
+
+  /**
+   * Number of entities that have all the given tags.
+   */
+  template <typename... Tags> std::size_t Count() {
+    const std::size_t families[] = {internal::TagFamily<Tags>::Id()...};
+    Select(families, sizeof...(Tags), mScratch);
+    std::size_t count = 0;
+    for (auto word : mScratch) {
+      for (; word != 0; word &= word - 1) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+private:
+  void SetBit(std::size_t family, std::uint32_t index);
+
+  void ClearBit(std::size_t family, std::uint32_t index);
+
+  /// ClearBit along with the bits of the linked tags.
+  void ClearTag(std::size_t family, std::uint32_t index);
+
+  bool TestBit(std::size_t family, std::uint32_t index) const;
+
+  void Select(const std::size_t *families, std::size_t count,
+              std::vector<uint64_t> &out) const;
+
+  /// Sets the bits of the entity indices below `capacity`.
+  static void SelectAll(std::size_t capacity, std::vector<uint64_t> &out);
+
+  void Exclude(const std::size_t *families, std::size_t count,
+               std::vector<uint64_t> &out) const;
+
+  std::vector<std::vector<uint64_t>> mColumns;
+  /// Pairs of a tag's family and the family of a tag cleared along with it.
+  std::vector<std::pair<std::size_t, std::size_t>> mLinks;
+  std::vector<uint64_t> mScratch;
+};
+
+#endif // NINPOTEST_TAGSET_H
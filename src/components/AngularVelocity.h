@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_ANGULARVELOCITY_H
 #define NINPOTEST_ANGULARVELOCITY_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Math/Vector3.h>
 
 struct AngularVelocity {
@@ -34,4 +36,6 @@ struct AngularVelocity {
   Urho3D::Vector3 value = Urho3D::Vector3::ZERO;
 };
 
+COMPONENT_POOL(AngularVelocity, 0, 1024, alignof(AngularVelocity))
+
 #endif // NINPOTEST_ANGULARVELOCITY_H
@@ -24,12 +24,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_BACKGROUNDMUSIC_H
 #define NINPOTEST_BACKGROUNDMUSIC_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Container/Str.h>
 
 struct BackgroundMusic {
   BackgroundMusic(const Urho3D::String value) : value(value) {}
 
   Urho3D::String value;
+  /// Seconds taken to fade from the previous track when `value` changes.
+  float crossfadeTime = 2.0f;
 };
 
+COMPONENT_POOL(BackgroundMusic, 0, 512, alignof(BackgroundMusic))
+
 #endif // NINPOTEST_BACKGROUNDMUSIC_H
@@ -19,6 +19,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_CAMERA_H
 #define NINPOTEST_CAMERA_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Math/Vector2.h>
 #include <Urho3D/Math/MathDefs.h>
 #include <Urho3D/Math/Plane.h>
@@ -44,4 +46,6 @@ struct Camera {
   bool flipVertical = false;
 };
 
+COMPONENT_POOL(Camera, 0, 128, alignof(Camera))
+
 #endif //NINPOTEST_CAMERA_H
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_DIRECTION_H
 #define NINPOTEST_DIRECTION_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Math/Quaternion.h>
 
 struct Direction {
@@ -40,4 +42,6 @@ struct Direction {
   Urho3D::Quaternion value = Urho3D::Quaternion::IDENTITY;
 };
 
+COMPONENT_POOL(Direction, 0, 512, alignof(Direction))
+
 #endif // NINPOTEST_DIRECTION_H
@@ -0,0 +1,46 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_HIERARCHY_H
+#define NINPOTEST_HIERARCHY_H
+
+#include "../common/ComponentPool.h"
+
+#include <entityx/Entity.h>
+
+/**
+ * Links an entity to its parent and its siblings. Children are an intrusive
+ * doubly linked list that starts at the parent's `firstChild`.
+ *
+ * These links are maintained by EntityHierarchy; do not modify them directly.
+ */
+struct Hierarchy {
+  entityx::Entity::Id parent = entityx::Entity::INVALID;
+  entityx::Entity::Id firstChild = entityx::Entity::INVALID;
+  entityx::Entity::Id previousSibling = entityx::Entity::INVALID;
+  entityx::Entity::Id nextSibling = entityx::Entity::INVALID;
+};
+
+COMPONENT_POOL(Hierarchy, 0, 512, alignof(Hierarchy))
+
+#endif // NINPOTEST_HIERARCHY_H
@@ -19,6 +19,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_LIGHT_H
 #define NINPOTEST_LIGHT_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Graphics/Light.h>
 #include <Urho3D/Math/Color.h>
 
@@ -39,4 +41,6 @@ struct Light {
   bool castShadows;
 };
 
+COMPONENT_POOL(Light, 0, 128, alignof(Light))
+
 #endif //NINPOTEST_LIGHT_H
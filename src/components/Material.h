@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_MATERIAL_H
 #define NINPOTEST_MATERIAL_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Container/Str.h>
 
 struct Material {
@@ -32,4 +34,6 @@ struct Material {
   Urho3D::String name;
 };
 
+COMPONENT_POOL(Material, 0, 512, alignof(Material))
+
 #endif // NINPOTEST_MATERIAL_H
@@ -19,6 +19,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_NAME_H
 #define NINPOTEST_NAME_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Container/Str.h>
 
 struct Name {
@@ -31,4 +33,6 @@ struct Name {
   Urho3D::String value;
 };
 
+COMPONENT_POOL(Name, 0, 512, alignof(Name))
+
 #endif //NINPOTEST_NAME_H
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_POSITION_H
 #define NINPOTEST_POSITION_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Math/Vector3.h>
 
 struct Position {
@@ -36,4 +38,6 @@ struct Position {
   Urho3D::Vector3 value;
 };
 
+COMPONENT_POOL(Position, 0, 1024, alignof(Position))
+
 #endif // NINPOTEST_POSITION_H
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_RENDERABLE_H
 #define NINPOTEST_RENDERABLE_H
 
+#include "../common/ComponentPool.h"
+
 #include <entityx/Entity.h>
 #include <Urho3D/Container/Str.h>
 
@@ -42,4 +44,6 @@ struct Renderable {
   entityx::Entity::Id parentEntityId;
 };
 
+COMPONENT_POOL(Renderable, 0, 1024, alignof(Renderable))
+
 #endif // NINPOTEST_RENDERABLE_H
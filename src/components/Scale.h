@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_SCALE_H
 #define NINPOTEST_SCALE_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Math/Vector3.h>
 
 struct Scale {
@@ -35,4 +37,6 @@ struct Scale {
   Urho3D::Vector3 value;
 };
 
+COMPONENT_POOL(Scale, 0, 1024, alignof(Scale))
+
 #endif // NINPOTEST_SCALE_H
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_SKYBOX_H
 #define NINPOTEST_SKYBOX_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Container/Str.h>
 
 struct Skybox {
@@ -34,4 +36,6 @@ struct Skybox {
   Urho3D::String material;
 };
 
+COMPONENT_POOL(Skybox, 0, 256, alignof(Skybox))
+
 #endif // NINPOTEST_SKYBOX_H
@@ -19,6 +19,10 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_SOUND_H
 #define NINPOTEST_SOUND_H
 
+#include "../common/ComponentPool.h"
+
+#include "../audio/SoundHandle.h"
+
 #include <cassert>
 
 #include <Urho3D/Container/Str.h>
@@ -30,14 +34,23 @@ struct Sound {
     validate();
   }
 
+  explicit Sound(SoundHandle handle) : handle(handle) {}
+
   Urho3D::String value;
+  /// Preloaded sound from the SoundBank, used instead of `value` when valid.
+  SoundHandle handle;
   float nearDistance = 10.0f;
   float farDistance = 100.0f;
   bool isLooped = false;
   Urho3D::String type = Urho3D::SOUND_EFFECT;
   bool isEnabled = true;
   bool isTemporary = true;
+  /// Once finished, the entity keeps its node and source and is handed out
+  /// again by the next PlaySound of the same sample on the same parent.
+  bool isReusable = false;
   float gain = 1.0f;
+  /// Voices with a higher priority are kept when the voice budget is full.
+  int priority = 0;
 
 private:
   inline void validate() {
@@ -45,4 +58,6 @@ private:
   }
 };
 
+COMPONENT_POOL(Sound, 0, 128, alignof(Sound))
+
 #endif //NINPOTEST_SOUND_H
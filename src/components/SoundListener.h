@@ -19,6 +19,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_SOUNDLISTENER_H
 #define NINPOTEST_SOUNDLISTENER_H
 
+#include "../common/ComponentPool.h"
+
 #include <entityx/Entity.h>
 
 struct SoundListener {
@@ -27,4 +29,6 @@ struct SoundListener {
   entityx::Entity::Id listenerId;
 };
 
+COMPONENT_POOL(SoundListener, 0, 1024, alignof(SoundListener))
+
 #endif //NINPOTEST_SOUNDLISTENER_H
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_MODEL_H
 #define NINPOTEST_MODEL_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Container/Str.h>
 
 struct StaticModel {
@@ -34,4 +36,6 @@ struct StaticModel {
   bool castShadows = true;
 };
 
+COMPONENT_POOL(StaticModel, 0, 256, alignof(StaticModel))
+
 #endif // NINPOTEST_MODEL_H
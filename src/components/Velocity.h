@@ -19,8 +19,12 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_VELOCITY_H
 #define NINPOTEST_VELOCITY_H
 
+#include "../common/ComponentPool.h"
+
 struct Velocity {
   Urho3D::Vector3 value = Urho3D::Vector3::ZERO;
 };
 
+COMPONENT_POOL(Velocity, 0, 1024, alignof(Velocity))
+
 #endif //NINPOTEST_VELOCITY_H
@@ -19,6 +19,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_VIEWPORT_H
 #define NINPOTEST_VIEWPORT_H
 
+#include "../common/ComponentPool.h"
+
 #include <Urho3D/Graphics/RenderPath.h>
 
 struct Viewport {
@@ -26,4 +28,6 @@ struct Viewport {
   Urho3D::RenderPath *renderPath = nullptr;
 };
 
+COMPONENT_POOL(Viewport, 0, 512, alignof(Viewport))
+
 #endif //NINPOTEST_VIEWPORT_H
@@ -0,0 +1,49 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_SOUNDEVENTS_H
+#define NINPOTEST_SOUNDEVENTS_H
+
+#include <entityx/Entity.h>
+
+/**
+ * Emitted when a reusable sound finished playing. The entity keeps its node
+ * and sound source while it waits to be played again.
+ */
+struct SoundParkedEvent {
+  explicit SoundParkedEvent(entityx::Entity entity) : entity(entity) {}
+
+  entityx::Entity entity;
+};
+
+/**
+ * Emitted when a parked sound entity is handed out again. Its `Sound`
+ * component already holds the new request.
+ */
+struct SoundReplayedEvent {
+  explicit SoundReplayedEvent(entityx::Entity entity) : entity(entity) {}
+
+  entityx::Entity entity;
+};
+
+#endif // NINPOTEST_SOUNDEVENTS_H
@@ -84,6 +84,7 @@ public:
   virtual void Stop() {
     state_.Reset();
     status_.Reset();
+    MemoryMonitor::CheckForLeaks();
   }
 
   /**
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "DemoState.h"
 
+#include "../common/GameLog.h"
 #include "../components/AngularVelocity.h"
 #include "../components/Direction.h"
 #include "../components/Name.h"
@@ -30,9 +31,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../components/Renderable.h"
 #include "../components/Scale.h"
 #include "../components/Sound.h"
+#include "../components/SoundListener.h"
+#include "../components/StaticModel.h"
 
 #include "../events/GameEvents.h"
 
+#include "../components/Camera.h"
 #include "../components/Light.h"
 #include "../components/Velocity.h"
 #include "../systems/MovementSystem.h"
@@ -42,16 +46,78 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <Urho3D/Graphics/Octree.h>
 #include <Urho3D/Graphics/Renderer.h>
 #include <Urho3D/Input/Input.h>
+#include <Urho3D/IO/FileSystem.h>
+
+namespace {
+/// Frames dumped by the trace hotkey, and where to.
+constexpr unsigned TRACE_FRAMES = 300;
+constexpr const char *TRACE_FILE = "ninpo-trace.json";
+/// Loaded instead of building the scene when present, written by F5.
+constexpr const char *SNAPSHOT_FILE = "ninpo-demo.snapshot";
+} // namespace
 
 DemoState::DemoState(Urho3D::Context *context)
     : GameState(context), mUI(new DemoUI(context)) {
-  systems.add<MovementSystem>();
-  systems.add<UrhoSystem>(context, mScene);
+  AddSystem<MovementSystem>("MovementSystem", mTags);
+  AddSystem<UrhoSystem>("UrhoSystem", context, mScene, mTags);
   systems.configure();
 
+  // Decode the effects up front, spawning them should not hit the disk
+  mSoundBank->Load({"Sounds/BigExplosion.wav"});
+  mExplosionSound = mSoundBank->Find("Sounds/BigExplosion.wav");
+
   mScene->CreateComponent<Urho3D::Octree>();
   mScene->CreateComponent<Urho3D::DebugRenderer>();
 
+  if (!GetSubsystem<Urho3D::FileSystem>()->FileExists(SNAPSHOT_FILE) ||
+      !LoadScene(SNAPSHOT_FILE)) {
+    BuildScene();
+  }
+  SetBackgroundMusic("Music/ibi - Some Sand.ogg");
+
+  SubscribeToUpdateEvents();
+  SubscribeToKeyDownEvents();
+}
+
+bool DemoState::LoadScene(const Urho3D::String &path) {
+  std::vector<entityx::Entity> loaded;
+  if (!LoadSnapshot(path, loaded)) {
+    return false;
+  }
+  // NOTE: The camera is the only entity with a sound listener, the rotating
+  // box the only one with an angular velocity
+  entities.each<Camera, SoundListener>(
+      [this](entityx::Entity entity, Camera &, SoundListener &) {
+        mCamera = entity;
+      });
+  entities.each<AngularVelocity, StaticModel>(
+      [this](entityx::Entity entity, AngularVelocity &, StaticModel &) {
+        mBox = entity;
+      });
+  if (!mCamera.valid() || !mBox.valid()) {
+    GAME_LOGERRORF("The snapshot '%s' does not hold the demo scene",
+                   path.CString());
+    // NOTE: Destroying a parent takes its children along
+    for (auto entity : loaded) {
+      if (entity.valid()) {
+        DestroyEntity(entity);
+      }
+    }
+    mCamera = mBox = entityx::Entity();
+    return false;
+  }
+  return true;
+}
+
+void DemoState::BuildScene() {
+  // The grid of boxes below accounts for most of the entities in this scene
+  const std::size_t expectedEntities = 512;
+  ReserveComponents<Renderable>(expectedEntities);
+  ReserveComponents<Name>(expectedEntities);
+  ReserveComponents<Position>(expectedEntities);
+  ReserveComponents<Scale>(expectedEntities);
+  ReserveComponents<StaticModel>(expectedEntities);
+
   // Let's put some sky in there.
   // Again, if the engine can't find these resources you need to check
   // the "ResourcePrefixPath". These files come with Urho3D.
@@ -59,6 +125,7 @@ DemoState::DemoState(Urho3D::Context *context)
   sky.assign<Skybox>("Models/Box.mdl", "Materials/Skybox.xml");
   // The scale actually does not matter
   sky.assign<Scale>(500.0f);
+  mTags.Set<Static>(sky);
 
   // Let's put a box in there.
   mBox = CreateRenderableEntity("Box");
@@ -80,6 +147,7 @@ DemoState::DemoState(Urho3D::Context *context)
       box.assign<Position>(x, -3, z);
       box.assign<Scale>(2, 2, 2);
       box.assign<StaticModel>("Models/Box.mdl", "Materials/Stone.xml");
+      mTags.Set<Static>(box);
     }
   }
 
@@ -129,10 +197,6 @@ DemoState::DemoState(Urho3D::Context *context)
     l.fov = 25;
     light.assign_from_copy(l);
   }
-  SetBackgroundMusic("Music/ibi - Some Sand.ogg");
-
-  SubscribeToUpdateEvents();
-  SubscribeToKeyDownEvents();
 }
 
 void DemoState::OnKeyDown(KeyDownData &data) {
@@ -148,6 +212,31 @@ void DemoState::OnKeyDown(KeyDownData &data) {
     GetSubsystem<Input>()->SetMouseVisible(
         !GetSubsystem<Input>()->IsMouseVisible());
   }
+
+  if (key == KEY_F5) {
+    if (SaveSnapshot(SNAPSHOT_FILE)) {
+      GAME_LOGINFOF("Saved the scene to '%s', it is loaded on startup",
+                    SNAPSHOT_FILE);
+    } else {
+      GAME_LOGERRORF("Could not save the scene to '%s'", SNAPSHOT_FILE);
+    }
+  }
+
+  if (key == KEY_F7) {
+    FrameTracer::SetEnabled(!FrameTracer::IsEnabled());
+    GAME_LOGINFOF("Frame tracing %s",
+                  FrameTracer::IsEnabled() ? "enabled" : "disabled");
+  }
+
+  if (key == KEY_F8) {
+    // Open it in https://ui.perfetto.dev or chrome://tracing
+    if (FrameTracer::Dump(TRACE_FILE, TRACE_FRAMES)) {
+      GAME_LOGINFOF("Wrote the last %u frames to '%s'", TRACE_FRAMES,
+                    TRACE_FILE);
+    } else {
+      GAME_LOGERRORF("Could not write the trace to '%s'", TRACE_FILE);
+    }
+  }
 }
 
 void DemoState::OnUpdate(UpdateEventData &data) {
@@ -161,8 +250,10 @@ void DemoState::OnUpdate(UpdateEventData &data) {
     MOVE_SPEED *= 10;
   }
 
-  if (input->GetKeyPress(Urho3D::KEY_SPACE)) {
-    auto explosion = ::Sound("Sounds/BigExplosion.wav");
+  // NOTE: The bank already logged it when the effect could not be decoded
+  if (input->GetKeyPress(Urho3D::KEY_SPACE) && mExplosionSound.IsValid()) {
+    auto explosion = ::Sound(mExplosionSound);
+    explosion.isReusable = true;
     PlaySound("BigExplosion", explosion, mBox.id());
   }
 
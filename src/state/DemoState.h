@@ -39,9 +39,16 @@ public:
   virtual void OnKeyDown(KeyDownData &data) override;
 
 private:
+  /// Populates the scene by hand.
+  void BuildScene();
+
+  /// Loads the scene from a snapshot and finds the entities driven by input.
+  bool LoadScene(const Urho3D::String &path);
+
   Urho3D::SharedPtr<DemoUI> mUI;
   entityx::Entity mCamera;
   entityx::Entity mBox;
+  SoundHandle mExplosionSound;
 };
 
 #endif // NINPOTEST_TESTSCENE_H
@@ -0,0 +1,126 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "EntityHierarchy.h"
+
+#include "../events/HierarchyEvents.h"
+
+EntityHierarchy::EntityHierarchy(entityx::EntityManager &entities,
+                                 entityx::EventManager &events)
+    : mEntities(entities), mEvents(events) {
+  events.subscribe<entityx::ComponentRemovedEvent<Hierarchy>>(*this);
+}
+
+void EntityHierarchy::receive(
+    const entityx::ComponentRemovedEvent<Hierarchy> &event) {
+  auto entity = event.entity;
+  Detach(entity);
+  // When this happens as part of DestroySubtree the children are already gone
+  EachChild(entity, [this](entityx::Entity child) { DestroySubtree(child); });
+}
+
+void EntityHierarchy::Attach(entityx::Entity child,
+                             entityx::Entity::Id parentId) {
+  // NOTE: get() asserts on stale ids, the parent may be gone already
+  if (parentId == entityx::Entity::INVALID || !mEntities.valid(parentId)) {
+    return;
+  }
+  auto parent = mEntities.get(parentId);
+  if (parent == child) {
+    return;
+  }
+  if (!child.has_component<Hierarchy>()) {
+    child.assign<Hierarchy>();
+  }
+  if (!parent.has_component<Hierarchy>()) {
+    parent.assign<Hierarchy>();
+  }
+  Detach(child);
+
+  auto childLinks = child.component<Hierarchy>();
+  auto parentLinks = parent.component<Hierarchy>();
+  childLinks->parent = parentId;
+  childLinks->nextSibling = parentLinks->firstChild;
+  if (parentLinks->firstChild != entityx::Entity::INVALID) {
+    mEntities.get(parentLinks->firstChild)
+        .component<Hierarchy>()
+        ->previousSibling = child.id();
+  }
+  parentLinks->firstChild = child.id();
+}
+
+void EntityHierarchy::Detach(entityx::Entity child) {
+  auto links = child.component<Hierarchy>();
+  if (!links || links->parent == entityx::Entity::INVALID) {
+    return;
+  }
+  if (links->previousSibling != entityx::Entity::INVALID) {
+    mEntities.get(links->previousSibling).component<Hierarchy>()->nextSibling =
+        links->nextSibling;
+  } else {
+    if (mEntities.valid(links->parent)) {
+      mEntities.get(links->parent).component<Hierarchy>()->firstChild =
+          links->nextSibling;
+    }
+  }
+  if (links->nextSibling != entityx::Entity::INVALID) {
+    mEntities.get(links->nextSibling).component<Hierarchy>()->previousSibling =
+        links->previousSibling;
+  }
+  links->parent = entityx::Entity::INVALID;
+  links->previousSibling = entityx::Entity::INVALID;
+  links->nextSibling = entityx::Entity::INVALID;
+}
+
+void EntityHierarchy::DestroySubtree(entityx::Entity root) {
+  if (!root.valid()) {
+    return;
+  }
+  // NOTE: Taking the scratch buffer keeps a destruction triggered by one of
+  // the listeners from overwriting the list that is being walked.
+  std::vector<entityx::Entity::Id> subtree;
+  subtree.swap(mSubtree);
+  CollectSubtree(root, subtree);
+  Detach(root);
+
+  mEvents.emit<SubtreeDestroyedEvent>(root, subtree);
+  for (auto itr = subtree.rbegin(); itr != subtree.rend(); ++itr) {
+    if (mEntities.valid(*itr)) {
+      mEntities.destroy(*itr);
+    }
+  }
+
+  subtree.clear();
+  subtree.swap(mSubtree);
+}
+
+void EntityHierarchy::CollectSubtree(entityx::Entity root,
+                                     std::vector<entityx::Entity::Id> &out) {
+  out.clear();
+  out.push_back(root.id());
+  // Breadth first, so every parent comes before its children
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    EachChild(mEntities.get(out[i]),
+              [&out](entityx::Entity child) { out.push_back(child.id()); });
+  }
+}
@@ -0,0 +1,87 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_ENTITYHIERARCHY_H
+#define NINPOTEST_ENTITYHIERARCHY_H
+
+#include <entityx/Entity.h>
+
+#include <vector>
+
+#include "../components/Hierarchy.h"
+
+/**
+ * Maintains the parent/child links of the Hierarchy component and tears down
+ * whole subtrees.
+ */
+class EntityHierarchy : public entityx::Receiver<EntityHierarchy> {
+public:
+  EntityHierarchy(entityx::EntityManager &entities,
+                  entityx::EventManager &events);
+
+  /**
+   * Keeps the links consistent when an entity goes away without going through
+   * DestroySubtree: it is detached from its parent and its children are
+   * destroyed along with it instead of being left orphaned.
+   */
+  void receive(const entityx::ComponentRemovedEvent<Hierarchy> &event);
+
+  /**
+   * Makes `child` the first child of `parentId`, detaching it from its
+   * previous parent if it had one.
+   */
+  void Attach(entityx::Entity child, entityx::Entity::Id parentId);
+
+  void Detach(entityx::Entity child);
+
+  template <typename Fn> void EachChild(entityx::Entity parent, Fn &&fn) {
+    auto links = parent.component<Hierarchy>();
+    if (!links) {
+      return;
+    }
+    auto childId = links->firstChild;
+    while (childId != entityx::Entity::INVALID) {
+      auto child = mEntities.get(childId);
+      // Read the link first, `fn` is allowed to detach the child
+      childId = child.component<Hierarchy>()->nextSibling;
+      fn(child);
+    }
+  }
+
+  /**
+   * Destroys `root` and all of its descendants in a single pass. Listeners get
+   * one SubtreeDestroyedEvent for the whole subtree before any entity is
+   * destroyed, then the entities are destroyed children first.
+   */
+  void DestroySubtree(entityx::Entity root);
+
+private:
+  void CollectSubtree(entityx::Entity root,
+                      std::vector<entityx::Entity::Id> &out);
+
+  entityx::EntityManager &mEntities;
+  entityx::EventManager &mEvents;
+  std::vector<entityx::Entity::Id> mSubtree;
+};
+
+#endif // NINPOTEST_ENTITYHIERARCHY_H
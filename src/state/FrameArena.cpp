@@ -0,0 +1,76 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "FrameArena.h"
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/WorkQueue.h>
+
+FrameArena::FrameArena(Urho3D::Context *context, std::size_t blockSize)
+    : Urho3D::Object(context) {
+  unsigned threads = 1;
+  auto workQueue = GetSubsystem<Urho3D::WorkQueue>();
+  if (workQueue) {
+    threads += workQueue->GetNumThreads();
+  }
+  for (unsigned i = 0; i < threads; ++i) {
+    mArenas.emplace_back(new LinearArena(blockSize));
+  }
+  SubscribeToEvent(Urho3D::E_ENDFRAME,
+                   URHO3D_HANDLER(FrameArena, HandleEndFrame));
+}
+
+std::size_t FrameArena::GetUsed() const {
+  std::size_t used = 0;
+  for (const auto &arena : mArenas) {
+    used += arena->GetUsed();
+  }
+  return used;
+}
+
+std::size_t FrameArena::GetCapacity() const {
+  std::size_t capacity = 0;
+  for (const auto &arena : mArenas) {
+    capacity += arena->GetCapacity();
+  }
+  return capacity;
+}
+
+std::size_t FrameArena::GetHighWaterMark() const {
+  std::size_t highWaterMark = 0;
+  for (const auto &arena : mArenas) {
+    highWaterMark += arena->GetHighWaterMark();
+  }
+  return highWaterMark;
+}
+
+void FrameArena::Reset() {
+  for (auto &arena : mArenas) {
+    arena->Reset();
+  }
+}
+
+void FrameArena::HandleEndFrame(Urho3D::StringHash eventType,
+                                Urho3D::VariantMap &eventData) {
+  Reset();
+}
@@ -0,0 +1,72 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_FRAMEARENA_H
+#define NINPOTEST_FRAMEARENA_H
+
+#include "../common/Arena.h"
+
+#include <Urho3D/Core/Object.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * Scratch memory that lives until the end of the current frame. There is one
+ * arena per WorkQueue thread so jobs can allocate without locking; a job
+ * running with `threadIndex` must only use `GetArena(threadIndex)`, and has to
+ * finish before E_ENDFRAME, when every arena is reset.
+ *
+ * The owning GameState registers it as a subsystem, so anything holding a
+ * context can reach it with `GetSubsystem<FrameArena>()`.
+ */
+class FrameArena : public Urho3D::Object {
+  URHO3D_OBJECT(FrameArena, Urho3D::Object)
+public:
+  explicit FrameArena(
+      Urho3D::Context *context,
+      std::size_t blockSize = LinearArena::DEFAULT_BLOCK_SIZE);
+
+  /// Arena of a WorkQueue thread. Index 0 is the main thread.
+  LinearArena &GetArena(unsigned threadIndex = 0) {
+    return *mArenas[threadIndex];
+  }
+
+  unsigned GetNumArenas() const { return static_cast<unsigned>(mArenas.size()); }
+
+  std::size_t GetUsed() const;
+
+  std::size_t GetCapacity() const;
+
+  std::size_t GetHighWaterMark() const;
+
+  void Reset();
+
+private:
+  void HandleEndFrame(Urho3D::StringHash eventType,
+                      Urho3D::VariantMap &eventData);
+
+  std::vector<std::unique_ptr<LinearArena>> mArenas;
+};
+
+#endif // NINPOTEST_FRAMEARENA_H
@@ -0,0 +1,124 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "FrameProfiler.h"
+#include "../common/FrameCounters.h"
+
+#include <Urho3D/Core/CoreEvents.h>
+
+#include <algorithm>
+
+FrameProfiler::FrameProfiler(Urho3D::Context *context)
+    : Urho3D::Object(context), mFrameTraceBegin(0) {
+  AddSection("Frame");
+  SubscribeToEvent(Urho3D::E_BEGINFRAME,
+                   URHO3D_HANDLER(FrameProfiler, HandleBeginFrame));
+}
+
+unsigned FrameProfiler::AddSection(const Urho3D::String &name) {
+  for (unsigned i = 0; i < mSections.size(); ++i) {
+    if (mSections[i].name == name) {
+      return i;
+    }
+  }
+  mSections.push_back(
+      Section{name, FrameTracer::Intern(name), {}, 0, 0, 0, 0, 0, false});
+  return static_cast<unsigned>(mSections.size() - 1);
+}
+
+void FrameProfiler::Reset() {
+  for (auto &section : mSections) {
+    section.next = 0;
+    section.count = 0;
+    section.frameTime = 0;
+    section.totalTime = 0;
+    section.totalSamples = 0;
+    section.hasRun = false;
+  }
+}
+
+ProfileStats FrameProfiler::GetStats(unsigned section) const {
+  const auto &entry = mSections[section];
+  ProfileStats stats{entry.name.CString(),
+                     entry.count,
+                     0.0f,
+                     0.0f,
+                     0.0f,
+                     0.0f,
+                     entry.totalSamples,
+                     entry.totalTime / 1000.0};
+  if (entry.count == 0) {
+    return stats;
+  }
+  auto begin = mScratch.begin();
+  auto end = std::copy(entry.window.begin(),
+                       entry.window.begin() + entry.count, begin);
+  auto minmax = std::minmax_element(begin, end);
+  stats.min = *minmax.first;
+  stats.max = *minmax.second;
+  float total = 0.0f;
+  for (auto itr = begin; itr != end; ++itr) {
+    total += *itr;
+  }
+  stats.avg = total / entry.count;
+  // Nearest rank
+  auto rank = (entry.count * 99 + 99) / 100 - 1;
+  std::nth_element(begin, begin + rank, end);
+  stats.p99 = begin[rank];
+  return stats;
+}
+
+void FrameProfiler::GetStats(std::vector<ProfileStats> &stats) const {
+  stats.clear();
+  for (unsigned i = 0; i < mSections.size(); ++i) {
+    stats.push_back(GetStats(i));
+  }
+}
+
+void FrameProfiler::HandleBeginFrame(Urho3D::StringHash eventType,
+                                     Urho3D::VariantMap &eventData) {
+  mFrameTimer.Reset();
+  FrameTracer::NextFrame();
+  mFrameTraceBegin = FrameTracer::IsEnabled() ? FrameTracer::Now() : 0;
+}
+
+void FrameProfiler::EndFrame() {
+  Record(FRAME_SECTION, mFrameTimer.GetUSec(false));
+  if (mFrameTraceBegin != 0 && FrameTracer::IsEnabled()) {
+    FrameTracer::Record(GetTraceName(FRAME_SECTION), mFrameTraceBegin,
+                        FrameTracer::Now());
+  }
+  for (auto &section : mSections) {
+    if (!section.hasRun) {
+      continue;
+    }
+    section.window[section.next] = section.frameTime / 1000.0f;
+    section.next = (section.next + 1) % WINDOW_SIZE;
+    section.count = std::min(section.count + 1, WINDOW_SIZE);
+    section.totalTime += section.frameTime;
+    ++section.totalSamples;
+    section.frameTime = 0;
+    section.hasRun = false;
+  }
+  FrameCounters::EndFrame();
+}
@@ -0,0 +1,183 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_FRAMEPROFILER_H
+#define NINPOTEST_FRAMEPROFILER_H
+
+#include <entityx/System.h>
+
+#include <Urho3D/Container/Str.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Core/Timer.h>
+
+#include "FrameTracer.h"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+struct ProfileStats {
+  const char *name;
+  /// Frames in the window during which the section ran.
+  unsigned samples;
+  /// Milliseconds spent in the section per frame.
+  float min;
+  float avg;
+  float max;
+  float p99;
+  /// Frames during which the section ran, since the last reset.
+  unsigned totalSamples;
+  /// Milliseconds spent in the section since the last reset.
+  double total;
+};
+
+/**
+ * Times named sections of the main thread, e.g. every system update and
+ * GameState phase, and keeps the time each of them took per frame over a
+ * sliding window of the last `WINDOW_SIZE` frames. A section running several
+ * times in a frame counts once, with the total; frames it did not run in are
+ * left out of its statistics.
+ *
+ * Sections also show up in the FrameTracer timeline, when it is enabled.
+ *
+ * The owning GameState registers it as a subsystem, so anything holding a
+ * context can reach it with `GetSubsystem<FrameProfiler>()`.
+ */
+class FrameProfiler : public Urho3D::Object {
+  URHO3D_OBJECT(FrameProfiler, Urho3D::Object)
+public:
+  static constexpr unsigned WINDOW_SIZE = 120;
+
+  /// Section timing whole frames, from E_BEGINFRAME to EndFrame.
+  static constexpr unsigned FRAME_SECTION = 0;
+
+  explicit FrameProfiler(Urho3D::Context *context);
+
+  /// Returns the section with the given name, adding it if needed.
+  unsigned AddSection(const Urho3D::String &name);
+
+  unsigned GetNumSections() const {
+    return static_cast<unsigned>(mSections.size());
+  }
+
+  /// Name of the section as it appears in the trace.
+  const char *GetTraceName(unsigned section) const {
+    return mSections[section].traceName;
+  }
+
+  /// Adds time spent in a section during the current frame.
+  void Record(unsigned section, long long microseconds) {
+    auto &entry = mSections[section];
+    entry.frameTime += microseconds;
+    entry.hasRun = true;
+  }
+
+  /// Forgets the time recorded so far, e.g. to leave out a warm up.
+  void Reset();
+
+  /**
+   * Closes the frame. Called by the owning GameState once its own E_ENDFRAME
+   * handling is done, so that OnEndFrame counts towards the frame it ran in.
+   */
+  void EndFrame();
+
+  /// Statistics of one section over the window.
+  ProfileStats GetStats(unsigned section) const;
+
+  /// Statistics of every section over the window, in the order they were
+  /// added.
+  void GetStats(std::vector<ProfileStats> &stats) const;
+
+private:
+  struct Section {
+    Urho3D::String name;
+    const char *traceName;
+    /// Milliseconds per frame, oldest entries get overwritten first.
+    std::array<float, WINDOW_SIZE> window;
+    unsigned next;
+    unsigned count;
+    long long frameTime;
+    long long totalTime;
+    unsigned totalSamples;
+    bool hasRun;
+  };
+
+  void HandleBeginFrame(Urho3D::StringHash eventType,
+                        Urho3D::VariantMap &eventData);
+
+  std::vector<Section> mSections;
+  Urho3D::HiresTimer mFrameTimer;
+  long long mFrameTraceBegin;
+  // NOTE: Only used while computing percentiles
+  mutable std::array<float, WINDOW_SIZE> mScratch;
+};
+
+/**
+ * Records the time from its construction to its destruction in a section of
+ * the profiler, if there is one, and traces it.
+ */
+class ScopedProfile {
+public:
+  ScopedProfile(FrameProfiler *profiler, unsigned section)
+      : mProfiler(profiler), mSection(section),
+        mTrace(profiler ? profiler->GetTraceName(section) : nullptr) {}
+
+  ~ScopedProfile() {
+    if (mProfiler) {
+      mProfiler->Record(mSection, mTimer.GetUSec(false));
+    }
+  }
+
+  ScopedProfile(const ScopedProfile &) = delete;
+  ScopedProfile &operator=(const ScopedProfile &) = delete;
+
+private:
+  FrameProfiler *mProfiler;
+  unsigned mSection;
+  TraceScope mTrace;
+  Urho3D::HiresTimer mTimer;
+};
+
+/**
+ * Registered in place of a system to time its updates. It shares the family
+ * of `S`, so the system manager still finds it as `S`.
+ */
+template <typename S> class ProfiledSystem final : public S {
+public:
+  template <typename... Args>
+  ProfiledSystem(FrameProfiler *profiler, unsigned section, Args &&... args)
+      : S(std::forward<Args>(args)...), mProfiler(profiler), mSection(section) {
+  }
+
+  void update(entityx::EntityManager &entities, entityx::EventManager &events,
+              entityx::TimeDelta dt) override {
+    ScopedProfile profile(mProfiler, mSection);
+    S::update(entities, events, dt);
+  }
+
+private:
+  FrameProfiler *mProfiler;
+  unsigned mSection;
+};
+
+#endif // NINPOTEST_FRAMEPROFILER_H
@@ -0,0 +1,170 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "FrameTracer.h"
+#include "../common/GameLog.h"
+
+#include <Urho3D/Core/Thread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> FrameTracer::sEnabled{false};
+std::atomic<unsigned> FrameTracer::sFrame{0};
+
+namespace {
+struct ThreadBuffer {
+  std::unique_ptr<TraceEvent[]> events;
+  /// Events recorded so far, the next one goes to `written % BUFFER_SIZE`.
+  std::atomic<unsigned long long> written;
+  unsigned thread;
+  bool isMain;
+};
+
+struct TracerState {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  // NOTE: A deque never moves its elements, so the names stay put
+  std::deque<std::string> names;
+  std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+TracerState &GetState() {
+  static TracerState state;
+  return state;
+}
+
+/// Buffers are never freed, threads keep theirs for as long as they run.
+ThreadBuffer &GetThreadBuffer() {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (!buffer) {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.buffers.emplace_back(new ThreadBuffer{
+        std::unique_ptr<TraceEvent[]>(new TraceEvent[FrameTracer::BUFFER_SIZE]),
+        {0},
+        static_cast<unsigned>(state.buffers.size()),
+        Urho3D::Thread::IsMainThread()});
+    buffer = state.buffers.back().get();
+  }
+  return *buffer;
+}
+
+void WriteJsonString(std::FILE *file, const char *text) {
+  std::fputc('"', file);
+  for (; *text; ++text) {
+    if (*text == '"' || *text == '\\') {
+      std::fputc('\\', file);
+    }
+    std::fputc(*text, file);
+  }
+  std::fputc('"', file);
+}
+} // namespace
+
+const char *FrameTracer::Intern(const Urho3D::String &name) {
+  auto &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto itr = std::find(state.names.begin(), state.names.end(), name.CString());
+  if (itr != state.names.end()) {
+    return itr->c_str();
+  }
+  state.names.emplace_back(name.CString());
+  return state.names.back().c_str();
+}
+
+long long FrameTracer::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - GetState().epoch)
+      .count();
+}
+
+void FrameTracer::Record(const char *name, long long begin, long long end) {
+  auto &buffer = GetThreadBuffer();
+  auto written = buffer.written.load(std::memory_order_relaxed);
+  auto duration = std::min<long long>(end - begin, 0xFFFFFFFFll);
+  buffer.events[written % BUFFER_SIZE] =
+      TraceEvent{name, begin, static_cast<unsigned>(duration),
+                 sFrame.load(std::memory_order_relaxed)};
+  buffer.written.store(written + 1, std::memory_order_release);
+}
+
+bool FrameTracer::Dump(const Urho3D::String &path, unsigned frames) {
+  auto file = std::fopen(path.CString(), "w");
+  if (!file) {
+    return false;
+  }
+  auto frame = sFrame.load(std::memory_order_relaxed);
+  auto firstFrame = frame >= frames ? frame - frames + 1 : 0;
+
+  auto &state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool first = true;
+  // Oldest frame every thread still has all events of
+  auto completeFrame = firstFrame;
+  for (const auto &buffer : state.buffers) {
+    std::fprintf(file,
+                 "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                 first ? "" : ",", buffer->thread,
+                 buffer->isMain ? "Main" : "Worker", buffer->thread);
+    first = false;
+    // NOTE: Other threads may still be recording, their oldest events can get
+    // overwritten while being written out
+    auto written = buffer->written.load(std::memory_order_acquire);
+    auto count = std::min<unsigned long long>(written, BUFFER_SIZE);
+    if (written > BUFFER_SIZE) {
+      // NOTE: The frame of the oldest event kept may have lost earlier events
+      auto oldest = buffer->events[(written - count) % BUFFER_SIZE].frame + 1;
+      completeFrame = std::max(completeFrame, oldest);
+    }
+    for (auto i = written - count; i < written; ++i) {
+      const auto &event = buffer->events[i % BUFFER_SIZE];
+      if (event.frame < firstFrame) {
+        continue;
+      }
+      std::fprintf(file, ",\n{\"name\":");
+      WriteJsonString(file, event.name);
+      // Timestamps are in microseconds
+      std::fprintf(file,
+                   ",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                   "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+                   buffer->thread, event.begin / 1000.0,
+                   event.duration / 1000.0, event.frame);
+    }
+  }
+  std::fprintf(file, "\n]}\n");
+  if (completeFrame > firstFrame) {
+    GAME_LOGWARNINGF("The trace only holds the last %u of the %u frames asked "
+                     "for, the older events were overwritten",
+                     frame - completeFrame + 1, frames);
+  }
+  return std::fclose(file) == 0;
+}
@@ -0,0 +1,124 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_FRAMETRACER_H
+#define NINPOTEST_FRAMETRACER_H
+
+#include <Urho3D/Container/Str.h>
+
+#include <atomic>
+
+/// One scope recorded by the tracer, timestamps are in nanoseconds.
+struct TraceEvent {
+  const char *name;
+  long long begin;
+  unsigned duration;
+  unsigned frame;
+};
+
+/**
+ * Timeline of the scopes that ran during the last frames, on every thread,
+ * that can be dumped as Chrome trace-event JSON and opened in Perfetto or
+ * chrome://tracing.
+ *
+ * Every thread records into a ring buffer of its own, the oldest events get
+ * overwritten first. Tracing is off until enabled; a disabled TRACE_SCOPE
+ * costs a relaxed atomic load.
+ *
+ * The tracer is process wide instead of a subsystem so that hot paths can
+ * record without looking anything up. FrameProfiler advances its frames.
+ */
+class FrameTracer {
+public:
+  /// Events kept per thread.
+  static constexpr unsigned BUFFER_SIZE = 1u << 16;
+
+  static bool IsEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+  static void SetEnabled(bool enabled) {
+    sEnabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns a copy of `name` that lives as long as the process does. Trace
+   * events only keep a pointer to their name and may outlive whatever
+   * recorded them, so names that are not literals have to be interned.
+   */
+  static const char *Intern(const Urho3D::String &name);
+
+  /// Nanoseconds since the tracer was first used.
+  static long long Now();
+
+  /// Records a scope of the calling thread.
+  static void Record(const char *name, long long begin, long long end);
+
+  /// Starts a new frame. Called by FrameProfiler at E_BEGINFRAME.
+  static void NextFrame() { sFrame.fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * Writes the events of the last `frames` frames to `path`. Call it from the
+   * main thread between frames. A warning is logged when the buffers wrapped
+   * around within those frames, the dump then misses their oldest part.
+   *
+   * @return false when the file could not be written
+   */
+  static bool Dump(const Urho3D::String &path, unsigned frames);
+
+private:
+  static std::atomic<bool> sEnabled;
+  static std::atomic<unsigned> sFrame;
+};
+
+/**
+ * Records the time from its construction to its destruction under `name`,
+ * which has to be a literal or interned with FrameTracer::Intern. A null name
+ * records nothing.
+ */
+class TraceScope {
+public:
+  explicit TraceScope(const char *name)
+      : mName(name && FrameTracer::IsEnabled() ? name : nullptr),
+        mBegin(mName ? FrameTracer::Now() : 0) {}
+
+  ~TraceScope() {
+    if (mName) {
+      FrameTracer::Record(mName, mBegin, FrameTracer::Now());
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *mName;
+  long long mBegin;
+};
+
+#define TRACE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT_IMPL(a, b)
+
+/// Traces the rest of the enclosing block.
+#define TRACE_SCOPE(name)                                                      \
+  TraceScope TRACE_SCOPE_CONCAT(traceScope, __LINE__)(name)
+
+#endif // NINPOTEST_FRAMETRACER_H
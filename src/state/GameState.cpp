@@ -22,54 +22,107 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include "GameState.h"
+#include "../common/GameLog.h"
 #include "../components/BackgroundMusic.h"
+#include "../components/Direction.h"
+#include "../components/Position.h"
+#include "../components/Scale.h"
+#include "../events/SoundEvents.h"
 #include "../events/SoundFinishedEventData.h"
+#include "WorldSnapshot.h"
 
+#include <Urho3D/Audio/Audio.h>
 #include <Urho3D/Audio/AudioEvents.h>
+#include <Urho3D/Audio/SoundListener.h>
 #include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Timer.h>
 #include <Urho3D/Input/InputEvents.h>
 #include <Urho3D/Audio/AudioEvents.h>
-#include <Urho3D/IO/Log.h>
 
 GameState::GameState(Urho3D::Context *context)
-    : Urho3D::Object(context),
+    : Urho3D::Object(context), mComponentPools(events),
       mResourceCache(*GetSubsystem<Urho3D::ResourceCache>()),
-      mScene(new Urho3D::Scene(context)),
-      mBackgroundMusic(CreateRenderableEntity("BackgroundMusic")) {
+      mScene(new Urho3D::Scene(context)), mFrameArena(new FrameArena(context)),
+      mSoundBank(new SoundBank(context)), mProfiler(new FrameProfiler(context)),
+      mMemoryMonitor(new MemoryMonitor(context, entities, *mScene)),
+      mTags(events),
+      mHierarchy(entities, events),
+      mBackgroundMusic(CreateRenderableEntity("BackgroundMusic")),
+      mSoundCoalescer(GetSubsystem<Urho3D::Time>()),
+      mCullInaudibleSounds(true), mParkedSounds(events), mHasEndFrame(false) {
+  GameLog::Attach(GetSubsystem<Urho3D::Log>());
+  context->RegisterSubsystem(mFrameArena.Get());
+  context->RegisterSubsystem(mSoundBank.Get());
+  context->RegisterSubsystem(mProfiler.Get());
+  context->RegisterSubsystem(mMemoryMonitor.Get());
+  // NOTE: The phase sections are replaced when subscribing to their event,
+  // before their handler can run
+  mBeginFrameSection = mKeyDownSection = mUpdateSection = mPostUpdateSection =
+      mRenderUpdateSection = mPostRenderUpdateSection = mEndFrameSection =
+          FrameProfiler::FRAME_SECTION;
+  mSoundFinishedSection = mProfiler->AddSection("SoundFinished");
+  // NOTE: Always handled, the profiler's frame is closed from here
+  SubscribeToEvent(Urho3D::E_ENDFRAME,
+                   URHO3D_HANDLER(GameState, HandleEndFrame));
   SubscribeToEvent(Urho3D::E_SOUNDFINISHED, URHO3D_HANDLER(GameState, HandleSoundFinished));
 }
 
+GameState::~GameState() {
+  if (context_->GetSubsystem<FrameArena>() == mFrameArena.Get()) {
+    context_->RemoveSubsystem<FrameArena>();
+  }
+  if (context_->GetSubsystem<SoundBank>() == mSoundBank.Get()) {
+    context_->RemoveSubsystem<SoundBank>();
+  }
+  if (context_->GetSubsystem<FrameProfiler>() == mProfiler.Get()) {
+    context_->RemoveSubsystem<FrameProfiler>();
+  }
+  if (context_->GetSubsystem<MemoryMonitor>() == mMemoryMonitor.Get()) {
+    context_->RemoveSubsystem<MemoryMonitor>();
+  }
+}
+
 void GameState::SubscribeToBeginFrameEvents() {
+  mBeginFrameSection = AddPhaseSection("OnBeginFrame");
   SubscribeToEvent(Urho3D::E_BEGINFRAME,
                    URHO3D_HANDLER(GameState, HandleBeginFrame));
 }
 
 void GameState::SubscribeToKeyDownEvents() {
+  mKeyDownSection = AddPhaseSection("OnKeyDown");
   SubscribeToEvent(Urho3D::E_KEYDOWN, URHO3D_HANDLER(GameState, HandleKeyDown));
 }
 
 void GameState::SubscribeToUpdateEvents() {
+  mUpdateSection = AddPhaseSection("OnUpdate");
   SubscribeToEvent(Urho3D::E_UPDATE, URHO3D_HANDLER(GameState, HandleUpdate));
 }
 
 void GameState::SubscribeToPostUpdateEvents() {
+  mPostUpdateSection = AddPhaseSection("OnPostUpdate");
   SubscribeToEvent(Urho3D::E_POSTUPDATE,
                    URHO3D_HANDLER(GameState, HandlePostUpdate));
 }
 
 void GameState::SubscribeToRenderUpdateEvents() {
+  mRenderUpdateSection = AddPhaseSection("OnRenderUpdate");
   SubscribeToEvent(Urho3D::E_RENDERUPDATE,
                    URHO3D_HANDLER(GameState, HandleRenderUpdate));
 }
 
 void GameState::SubscribeToPostRenderUpdateEvents() {
+  mPostRenderUpdateSection = AddPhaseSection("OnPostRenderUpdate");
   SubscribeToEvent(Urho3D::E_POSTRENDERUPDATE,
                    URHO3D_HANDLER(GameState, HandlePostRenderUpdate));
 }
 
 void GameState::SubscribeToEndFrameEvents() {
-  SubscribeToEvent(Urho3D::E_ENDFRAME,
-                   URHO3D_HANDLER(GameState, HandleEndFrame));
+  mEndFrameSection = AddPhaseSection("OnEndFrame");
+  mHasEndFrame = true;
+}
+
+unsigned GameState::AddPhaseSection(const char *phase) {
+  return mProfiler->AddSection(GetTypeName() + "::" + phase);
 }
 
 void GameState::SubscribeToAllEvents() {
@@ -84,12 +137,14 @@ void GameState::SubscribeToAllEvents() {
 
 void GameState::HandleBeginFrame(Urho3D::StringHash eventType,
                                  Urho3D::VariantMap &eventData) {
+  ScopedProfile profile(mProfiler.Get(), mBeginFrameSection);
   BeginFrameData data{eventData};
   OnBeginFrame(data);
 }
 
 void GameState::HandleKeyDown(Urho3D::StringHash eventType,
                               Urho3D::VariantMap &eventData) {
+  ScopedProfile profile(mProfiler.Get(), mKeyDownSection);
   KeyDownData data{eventData};
   OnKeyDown(data);
 }
@@ -97,36 +152,49 @@ void GameState::HandleKeyDown(Urho3D::StringHash eventType,
 void GameState::HandleUpdate(Urho3D::StringHash eventType,
                              Urho3D::VariantMap &eventData) {
   UpdateEventData data{eventData};
-  OnUpdate(data);
+  {
+    // NOTE: The systems are timed on their own
+    ScopedProfile profile(mProfiler.Get(), mUpdateSection);
+    OnUpdate(data);
+  }
   float timeStep = data.GetTimeStep();
   systems.update_all(timeStep);
 }
 
 void GameState::HandlePostUpdate(Urho3D::StringHash eventType,
                                  Urho3D::VariantMap &eventData) {
+  ScopedProfile profile(mProfiler.Get(), mPostUpdateSection);
   UpdateEventData data{eventData};
   OnPostUpdate(data);
 }
 
 void GameState::HandleRenderUpdate(Urho3D::StringHash eventType,
                                    Urho3D::VariantMap &eventData) {
+  ScopedProfile profile(mProfiler.Get(), mRenderUpdateSection);
   UpdateEventData data{eventData};
   OnRenderUpdate(data);
 }
 
 void GameState::HandlePostRenderUpdate(Urho3D::StringHash eventType,
                                        Urho3D::VariantMap &eventData) {
+  ScopedProfile profile(mProfiler.Get(), mPostRenderUpdateSection);
   UpdateEventData data{eventData};
   OnPostRenderUpdate(data);
 }
 
 void GameState::HandleEndFrame(Urho3D::StringHash eventType,
                                Urho3D::VariantMap &eventData) {
-  OnEndFrame();
+  if (mHasEndFrame) {
+    ScopedProfile profile(mProfiler.Get(), mEndFrameSection);
+    OnEndFrame();
+  }
+  mProfiler->EndFrame();
 }
 
 void GameState::HandleSoundFinished(Urho3D::StringHash eventType,
                                Urho3D::VariantMap &eventData) {
+  ScopedProfile profile(mProfiler.Get(), mSoundFinishedSection);
+  FrameCounters::Add(COUNTER_SOUNDS_FINISHED);
   auto data = SoundFinishedEventData{eventData};
   auto node = data.GetNode();
   auto idVariant = node->GetVar(Renderable::ENTITY_ID_NODE_VAR);
@@ -137,19 +205,52 @@ void GameState::HandleSoundFinished(Urho3D::StringHash eventType,
   auto entityId = entityx::Entity::Id(idValue);
   auto entity = entities.get(entityId);
   if (!entity.valid()) {
-    URHO3D_LOGERRORF("The node associated with the sound has an invalid entity associated with it");
+    GAME_LOGERRORF("The node associated with the sound has an invalid entity associated with it");
     return;
   } else if (!entity.has_component<Sound>()) {
     return;
   }
   OnSoundFinished(entity, data);
-  URHO3D_LOGDEBUGF("Destroying sound entity...");
+  auto sound = entity.component<Sound>();
+  auto renderable = entity.component<Renderable>();
+  auto parentId =
+      renderable ? renderable->parentEntityId : entityx::Entity::INVALID;
+  if (sound->isReusable && mParkedSounds.Park(entity, *sound, parentId)) {
+    GAME_LOGDEBUGF("Parking sound entity...");
+    mSoundCoalescer.Untrack(entity, *sound, parentId);
+    events.emit<SoundParkedEvent>(entity);
+    return;
+  }
+  GAME_LOGDEBUGF("Destroying sound entity...");
   // NOTE: This order of removal is for a purpose:
   // - If the sound gets removed after 'Renderable' the node will get destroyed, so delete it first
   // - If the name gets removed before 'Renderable' the node removal will not have the necessary debug information
   entity.remove<Sound>();
   entity.remove<Renderable>();
-  entity.destroy();
+  DestroyEntity(entity);
+}
+
+bool GameState::SaveSnapshot(const Urho3D::String &path) {
+  return WorldSnapshot(entities, mTags).Save(path);
+}
+
+bool GameState::LoadSnapshot(const Urho3D::String &path,
+                             std::vector<entityx::Entity> &loaded) {
+  const auto first = loaded.size();
+  if (!WorldSnapshot(entities, mTags).Load(path, loaded)) {
+    return false;
+  }
+  FrameCounters::Add(COUNTER_ENTITIES_CREATED, loaded.size() - first);
+  // NOTE: Parents are linked after all entities exist, a child may have been
+  // saved before its parent
+  for (auto i = first; i < loaded.size(); ++i) {
+    auto entity = loaded[i];
+    auto renderable = entity.component<Renderable>();
+    if (renderable && renderable->IsChild()) {
+      mHierarchy.Attach(entity, renderable->parentEntityId);
+    }
+  }
+  return true;
 }
 
 void GameState::SetBackgroundMusic(const Urho3D::String &filePath) {
@@ -162,27 +263,86 @@ void GameState::SetBackgroundMusic(const Urho3D::String &filePath) {
 }
 
 void GameState::PlaySound(const Sound &sound) {
-  auto entity = CreateRenderableEntity();
-  PlayEntitySound(entity, sound);
+  StartSound(nullptr, sound, entityx::Entity::INVALID);
 }
 
 void GameState::PlaySound(const Urho3D::String &name, const Sound &sound) {
-  auto entity = CreateRenderableEntity(name);
-  PlayEntitySound(entity, sound);
+  StartSound(&name, sound, entityx::Entity::INVALID);
 }
 
 void GameState::PlaySound(const Sound &sound,
                           const entityx::Entity::Id parentId) {
-  auto entity = CreateRenderableEntity(parentId);
-  PlayEntitySound(entity, sound);
+  StartSound(nullptr, sound, parentId);
 }
 
 void GameState::PlaySound(const Urho3D::String &name, const Sound &sound,
                           const entityx::Entity::Id parentId) {
-  auto entity = CreateRenderableEntity(name, parentId);
-  PlayEntitySound(entity, sound);
+  StartSound(&name, sound, parentId);
+}
+
+void GameState::StartSound(const Urho3D::String *name, const Sound &sound,
+                           const entityx::Entity::Id parentId) {
+  FrameCounters::Add(COUNTER_SOUNDS_REQUESTED);
+  if (IsOutOfEarshot(sound, parentId)) {
+    FrameCounters::Add(COUNTER_SOUNDS_CULLED);
+    return;
+  }
+  if (mSoundCoalescer.Merge(sound, parentId)) {
+    return;
+  }
+  auto entity = sound.isReusable ? mParkedSounds.Take(sound, parentId)
+                                 : entityx::Entity();
+  if (entity.valid()) {
+    auto entityName = entity.component<Name>();
+    if (name && entityName) {
+      entityName->value = *name;
+    }
+    *entity.component<Sound>() = sound;
+    events.emit<SoundReplayedEvent>(entity);
+  } else {
+    if (parentId == entityx::Entity::INVALID) {
+      entity = name ? CreateRenderableEntity(*name) : CreateRenderableEntity();
+    } else {
+      entity = name ? CreateRenderableEntity(*name, parentId)
+                    : CreateRenderableEntity(parentId);
+    }
+    entity.assign_from_copy(sound);
+  }
+  mSoundCoalescer.Track(entity, sound, parentId);
 }
 
-inline void GameState::PlayEntitySound(entityx::Entity entity, const Sound &sound) {
-  entity.assign_from_copy(sound);
+bool GameState::IsOutOfEarshot(const Sound &sound,
+                               const entityx::Entity::Id parentId) {
+  // NOTE: Loops may come into range later, the voice manager keeps them
+  // virtual until then
+  if (!mCullInaudibleSounds || sound.isLooped) {
+    return false;
+  }
+  auto audio = GetSubsystem<Urho3D::Audio>();
+  auto listener = audio ? audio->GetListener() : nullptr;
+  if (!listener || !listener->GetNode()) {
+    return false;
+  }
+  Urho3D::Vector3 position = Urho3D::Vector3::ZERO;
+  auto id = parentId;
+  while (id != entityx::Entity::INVALID && entities.valid(id)) {
+    auto entity = entities.get(id);
+    auto scale = entity.component<Scale>();
+    if (scale) {
+      position *= scale->value;
+    }
+    auto direction = entity.component<Direction>();
+    if (direction) {
+      position = direction->value * position;
+    }
+    auto localPosition = entity.component<Position>();
+    if (localPosition) {
+      position += localPosition->value;
+    }
+    auto renderable = entity.component<Renderable>();
+    id = renderable ? renderable->parentEntityId : entityx::Entity::INVALID;
+  }
+  auto distance =
+      (position - listener->GetNode()->GetWorldPosition()).Length();
+  return distance >= sound.farDistance;
 }
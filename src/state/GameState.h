@@ -30,6 +30,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <Urho3D/Resource/ResourceCache.h>
 #include <Urho3D/Scene/Scene.h>
 
+#include "../audio/ParkedSounds.h"
+#include "../audio/SoundBank.h"
+#include "../audio/SoundCoalescer.h"
+#include "../common/ComponentPool.h"
+#include "../common/FrameCounters.h"
+#include "../common/TagSet.h"
 #include "../events/BeginFrameData.h"
 #include "../events/KeyDownData.h"
 #include "../events/UpdateEventData.h"
@@ -37,14 +43,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../components/Name.h"
 #include "../components/Renderable.h"
 #include "../components/Sound.h"
+#include "../components/Tags.h"
 #include "../events/SoundFinishedEventData.h"
 #include "../ui/StatusOverlay.h"
+#include "EntityHierarchy.h"
+#include "FrameArena.h"
+#include "FrameProfiler.h"
+#include "MemoryMonitor.h"
+
+#include <vector>
 
 class GameState : public Urho3D::Object, public entityx::EntityX {
   URHO3D_OBJECT(GameState, Urho3D::Object)
 public:
   GameState(Urho3D::Context *context);
-  virtual ~GameState() = default;
+  virtual ~GameState();
 
 protected:
   /**
@@ -143,10 +156,13 @@ private:
                            Urho3D::VariantMap &eventData);
 
 protected:
-  inline entityx::Entity CreateEntity() { return entities.create(); }
+  inline entityx::Entity CreateEntity() {
+    FrameCounters::Add(COUNTER_ENTITIES_CREATED);
+    return entities.create();
+  }
 
   inline entityx::Entity CreateEntity(const Urho3D::String &name) {
-    auto entity = entities.create();
+    auto entity = CreateEntity();
     entity.assign<Name>(name);
     return entity;
   }
@@ -167,6 +183,7 @@ protected:
   CreateRenderableEntity(const entityx::Entity::Id parentId) {
     auto entity = CreateEntity();
     entity.assign<Renderable>(parentId);
+    mHierarchy.Attach(entity, parentId);
     return entity;
   }
 
@@ -175,9 +192,58 @@ protected:
                          const entityx::Entity::Id parentId) {
     auto entity = CreateEntity(name);
     entity.assign<Renderable>(parentId);
+    mHierarchy.Attach(entity, parentId);
     return entity;
   }
 
+  /**
+   * Destroys the entity along with all of its children. The scene nodes of
+   * the whole subtree are removed in one go.
+   */
+  inline void DestroyEntity(entityx::Entity entity) {
+    mHierarchy.DestroySubtree(entity);
+  }
+
+  /**
+   * Writes the entities of this state to a snapshot file, see WorldSnapshot.
+   */
+  bool SaveSnapshot(const Urho3D::String &path);
+
+  /**
+   * Adds the entities of a snapshot file to this state, appending them to
+   * `loaded`, and links them to their parents. UrhoSystem creates their scene
+   * nodes as they get synced.
+   */
+  bool LoadSnapshot(const Urho3D::String &path,
+                    std::vector<entityx::Entity> &loaded);
+
+  /**
+   * Pre-allocates room for `count` components of type `C` so that populating
+   * a scene does not grow its pool one block at a time. Keep in mind that
+   * entityx indexes pools by entity index, so `count` should cover the number
+   * of entities that will be alive, not only the ones having the component.
+   */
+  template <typename C> void ReserveComponents(std::size_t count) {
+    ComponentPools::Reserve<C>(count);
+  }
+
+  /**
+   * Scratch memory for the main thread that is released at the end of the
+   * frame. Use `mFrameArena->GetArena(threadIndex)` from WorkQueue jobs.
+   */
+  inline LinearArena &GetFrameArena() { return mFrameArena->GetArena(); }
+
+  /**
+   * Adds a system whose updates the frame profiler times under `name`. The
+   * system is still found with `systems.system<S>()`.
+   */
+  template <typename S, typename... Args>
+  std::shared_ptr<S> AddSystem(const char *name, Args &&... args) {
+    auto section = mProfiler->AddSection(name);
+    return systems.add<ProfiledSystem<S>>(mProfiler.Get(), section,
+                                          std::forward<Args>(args)...);
+  }
+
   void SetBackgroundMusic(const Urho3D::String &filePath);
 
   void PlaySound(const Sound &sound);
@@ -186,13 +252,52 @@ protected:
   void PlaySound(const Urho3D::String &name, const Sound &sound,
                  const entityx::Entity::Id parentId);
 
+private:
+  // NOTE: This has to be constructed before any entity gets created, otherwise
+  // the components of that entity will not be counted.
+  ComponentPoolTracker mComponentPools;
+
 protected:
   Urho3D::ResourceCache &mResourceCache;
   Urho3D::SharedPtr<Urho3D::Scene> mScene;
+  Urho3D::SharedPtr<FrameArena> mFrameArena;
+  Urho3D::SharedPtr<SoundBank> mSoundBank;
+  Urho3D::SharedPtr<FrameProfiler> mProfiler;
+  Urho3D::SharedPtr<MemoryMonitor> mMemoryMonitor;
+  TagSet mTags;
+  EntityHierarchy mHierarchy;
   entityx::Entity mBackgroundMusic;
+  /// Merges identical PlaySound requests, see SoundCoalescer.
+  SoundCoalescer mSoundCoalescer;
+  /// Drop one-shots that start beyond their far distance from the listener
+  /// before anything is created for them.
+  bool mCullInaudibleSounds;
 
 private:
-  void PlayEntitySound(entityx::Entity entity, const Sound &sound);
+  /// Adds the profiler section of one of the On* phases of this state.
+  unsigned AddPhaseSection(const char *phase);
+
+  void StartSound(const Urho3D::String *name, const Sound &sound,
+                  const entityx::Entity::Id parentId);
+
+  /**
+   * Whether a one-shot played on `parentId` would start out of the listener's
+   * range. The parent's position is put together from the transform
+   * components of it and its ancestors, the way their nodes are placed.
+   */
+  bool IsOutOfEarshot(const Sound &sound, const entityx::Entity::Id parentId);
+
+  ParkedSounds mParkedSounds;
+  unsigned mBeginFrameSection;
+  unsigned mKeyDownSection;
+  unsigned mUpdateSection;
+  unsigned mPostUpdateSection;
+  unsigned mRenderUpdateSection;
+  unsigned mPostRenderUpdateSection;
+  unsigned mEndFrameSection;
+  unsigned mSoundFinishedSection;
+  /// Whether OnEndFrame gets called, see SubscribeToEndFrameEvents.
+  bool mHasEndFrame;
 };
 
 #define GAME_STATE(ClassName) URHO3D_OBJECT(ClassName, GameState)
@@ -0,0 +1,168 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "MemoryMonitor.h"
+
+#include "../common/ComponentPool.h"
+#include "../common/GameLog.h"
+#include "../components/Name.h"
+#include "../components/StaticModel.h"
+#include "../systems/providers/scene/InstanceCounters.h"
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#include <vector>
+
+#if defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+unsigned MemoryMonitor::sLiveMonitors = 0;
+
+namespace {
+std::size_t GetHeapBytes(const Urho3D::String &value) {
+  return value.Capacity();
+}
+} // namespace
+
+MemoryMonitor::MemoryMonitor(Urho3D::Context *context,
+                             entityx::EntityManager &entities,
+                             Urho3D::Scene &scene)
+    : Urho3D::Object(context), mEntities(entities), mScene(scene),
+      mLogTime(0.0f) {
+  if (sLiveMonitors == 0) {
+    CheckForLeaks();
+  }
+  ++sLiveMonitors;
+  SubscribeToEvent(Urho3D::E_UPDATE,
+                   URHO3D_HANDLER(MemoryMonitor, HandleUpdate));
+}
+
+MemoryMonitor::~MemoryMonitor() { --sLiveMonitors; }
+
+void MemoryMonitor::GetStats(MemoryStats &stats) {
+  stats.poolBytes = ComponentPools::GetTotalBytes();
+  stats.stringBytes = 0;
+  mEntities.each<Name>([&stats](entityx::Entity, Name &name) {
+    stats.stringBytes += GetHeapBytes(name.value);
+  });
+  mEntities.each<StaticModel>([&stats](entityx::Entity, StaticModel &model) {
+    stats.stringBytes +=
+        GetHeapBytes(model.model) + GetHeapBytes(model.material);
+  });
+  stats.instances = InstanceCounters::GetTotalLive();
+  stats.nodes = mScene.GetNumChildren(true);
+  mScene.GetDerivedComponents<Urho3D::Drawable>(mDrawables, true);
+  stats.drawables = mDrawables.Size();
+  mDrawables.Clear();
+  auto cache = GetSubsystem<Urho3D::ResourceCache>();
+  stats.resourceBytes = cache ? cache->GetTotalMemoryUse() : 0;
+  stats.residentBytes = GetResidentBytes();
+}
+
+void MemoryMonitor::Log() {
+  MemoryStats stats;
+  GetStats(stats);
+  // NOTE: Urho3D's formatter only knows single letter conversions
+  GAME_LOGINFOF("Memory: %u KiB resident, %u KiB resources, %u KiB pools, "
+                "%u KiB strings, %u nodes, %u drawables, %u instances",
+                static_cast<unsigned>(stats.residentBytes / 1024),
+                static_cast<unsigned>(stats.resourceBytes / 1024),
+                static_cast<unsigned>(stats.poolBytes / 1024),
+                static_cast<unsigned>(stats.stringBytes / 1024),
+                static_cast<unsigned>(stats.nodes),
+                static_cast<unsigned>(stats.drawables),
+                static_cast<unsigned>(stats.instances));
+}
+
+std::size_t MemoryMonitor::GetResidentBytes() {
+#if defined(__linux__)
+  auto file = std::fopen("/proc/self/statm", "r");
+  if (!file) {
+    return 0;
+  }
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  auto read = std::fscanf(file, "%lu %lu", &size, &resident);
+  std::fclose(file);
+  return read == 2
+             ? resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE))
+             : 0;
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return 0;
+  }
+  return info.resident_size;
+#elif defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                               sizeof(counters))) {
+    return 0;
+  }
+  return counters.WorkingSetSize;
+#else
+  return 0;
+#endif
+}
+
+std::size_t MemoryMonitor::CheckForLeaks() {
+  if (sLiveMonitors != 0) {
+    return 0;
+  }
+  std::vector<InstanceStats> instances;
+  InstanceCounters::GetStats(instances);
+  std::size_t leaked = 0;
+  for (const auto &stats : instances) {
+    if (stats.live != 0) {
+      GAME_LOGWARNINGF("%u '%s' instances outlived their game state",
+                       static_cast<unsigned>(stats.live), stats.name);
+      leaked += stats.live;
+    }
+  }
+  return leaked;
+}
+
+void MemoryMonitor::HandleUpdate(Urho3D::StringHash eventType,
+                                 Urho3D::VariantMap &eventData) {
+  // The overlay shows the numbers whenever there is something to draw on
+  if (GetSubsystem<Urho3D::Graphics>()) {
+    return;
+  }
+  mLogTime += eventData[Urho3D::Update::P_TIMESTEP].GetFloat();
+  if (mLogTime < LOG_INTERVAL) {
+    return;
+  }
+  mLogTime = 0.0f;
+  Log();
+}
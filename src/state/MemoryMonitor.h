@@ -0,0 +1,94 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_MEMORYMONITOR_H
+#define NINPOTEST_MEMORYMONITOR_H
+
+#include <entityx/Entity.h>
+
+#include <Urho3D/Container/Vector.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Graphics/Drawable.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <cstddef>
+
+struct MemoryStats {
+  /// Bytes allocated by the entityx pools, see ComponentPools.
+  std::size_t poolBytes;
+  /// Heap bytes held by the strings of Name and StaticModel components.
+  std::size_t stringBytes;
+  /// Scene objects held by instance components, see InstanceCounters.
+  std::size_t instances;
+  std::size_t nodes;
+  std::size_t drawables;
+  /// Memory used by the resources in the cache.
+  std::size_t resourceBytes;
+  /// Resident set size of the process, 0 where it can't be queried.
+  std::size_t residentBytes;
+};
+
+/**
+ * Reports how much memory the game state's entities and scene take. When
+ * running headless, where there is no StatusOverlay to look at, it logs the
+ * numbers every `LOG_INTERVAL` seconds instead.
+ *
+ * It also warns when a game state starts while scene objects of a previous
+ * one are still held; those have leaked.
+ *
+ * The owning GameState registers it as a subsystem.
+ */
+class MemoryMonitor : public Urho3D::Object {
+  URHO3D_OBJECT(MemoryMonitor, Urho3D::Object)
+public:
+  static constexpr float LOG_INTERVAL = 10.0f;
+
+  MemoryMonitor(Urho3D::Context *context, entityx::EntityManager &entities,
+                Urho3D::Scene &scene);
+  virtual ~MemoryMonitor();
+
+  /// Walks every entity and scene node, not meant to be called every frame.
+  void GetStats(MemoryStats &stats);
+
+  void Log();
+
+  /// Resident set size of the process, 0 where it can't be queried.
+  static std::size_t GetResidentBytes();
+
+  /// Logs the scene objects still held, when no game state is left to hold
+  /// them. Returns the number of leaked objects.
+  static std::size_t CheckForLeaks();
+
+private:
+  void HandleUpdate(Urho3D::StringHash eventType,
+                    Urho3D::VariantMap &eventData);
+
+  entityx::EntityManager &mEntities;
+  Urho3D::Scene &mScene;
+  float mLogTime;
+  Urho3D::PODVector<Urho3D::Drawable *> mDrawables;
+
+  static unsigned sLiveMonitors;
+};
+
+#endif // NINPOTEST_MEMORYMONITOR_H
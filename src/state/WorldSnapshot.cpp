@@ -0,0 +1,808 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#include "WorldSnapshot.h"
+
+#include "../common/ComponentPool.h"
+#include "../common/GameLog.h"
+#include "../common/MappedFile.h"
+#include "../components/AngularVelocity.h"
+#include "../components/BackgroundMusic.h"
+#include "../components/Camera.h"
+#include "../components/Direction.h"
+#include "../components/Light.h"
+#include "../components/Material.h"
+#include "../components/Name.h"
+#include "../components/Position.h"
+#include "../components/Renderable.h"
+#include "../components/Scale.h"
+#include "../components/Skybox.h"
+#include "../components/Sound.h"
+#include "../components/SoundListener.h"
+#include "../components/StaticModel.h"
+#include "../components/Tags.h"
+#include "../components/Velocity.h"
+
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Math/Plane.h>
+#include <Urho3D/Math/Vector4.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+/*
+ * File layout, in native byte order:
+ *
+ *   SnapshotHeader
+ *   for every component type and tag that any saved entity has:
+ *     uint32 size of every field
+ *     uint32 index of every entity having it, ascending
+ *     one column per field, holding the field of every such entity
+ *   string table: uint32 offsets, one per string and one past the last, into
+ *     the characters that follow them
+ *   SnapshotType for every type stored
+ *
+ * Every section starts at a multiple of COLUMN_ALIGNMENT.
+ */
+
+namespace {
+constexpr char MAGIC[8] = {'N', 'I', 'N', 'P', 'O', 'W', 'S', '\0'};
+/// Sections start at multiples of this, so that columns can be read in place.
+constexpr std::size_t COLUMN_ALIGNMENT = 16;
+constexpr std::size_t TYPE_NAME_SIZE = 32;
+/// Stored for a reference to an entity that is not in the snapshot.
+constexpr std::uint32_t NO_ENTITY = 0xffffffffu;
+
+struct SnapshotHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t entityCount;
+  std::uint32_t typeCount;
+  std::uint32_t stringCount;
+  std::uint64_t typesOffset;
+  std::uint64_t stringsOffset;
+  std::uint64_t fileSize;
+};
+
+struct SnapshotType {
+  char name[TYPE_NAME_SIZE];
+  std::uint32_t fieldCount;
+  /// Entities having the component or tag.
+  std::uint32_t count;
+  /// Where the field sizes start, the columns follow them.
+  std::uint64_t offset;
+};
+
+std::uint64_t AlignUp(std::uint64_t value) {
+  return (value + COLUMN_ALIGNMENT - 1) & ~std::uint64_t(COLUMN_ALIGNMENT - 1);
+}
+
+/// Whether `length` bytes at `offset` are within a file of `size` bytes.
+bool Fits(std::uint64_t offset, std::uint64_t length, std::uint64_t size) {
+  return offset <= size && length <= size - offset;
+}
+
+template <typename T>
+void AppendBytes(std::vector<unsigned char> &out, const T &value) {
+  auto bytes = reinterpret_cast<const unsigned char *>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+class SnapshotWriter {
+public:
+  SnapshotWriter(entityx::EntityManager &entities,
+                 const std::vector<entityx::Entity> &saved)
+      : mEntities(entities), mSaved(saved),
+        mIndices(entities.capacity(), NO_ENTITY) {
+    for (std::uint32_t i = 0; i < saved.size(); ++i) {
+      mIndices[saved[i].id().index()] = i;
+    }
+    mData.resize(AlignUp(sizeof(SnapshotHeader)));
+  }
+
+  const std::vector<entityx::Entity> &GetSaved() const { return mSaved; }
+
+  std::uint32_t GetIndex(entityx::Entity::Id id) const {
+    if (!mEntities.valid(id)) {
+      return NO_ENTITY;
+    }
+    auto index = mIndices[id.index()];
+    return index != NO_ENTITY && mSaved[index].id() == id ? index : NO_ENTITY;
+  }
+
+  std::uint32_t Intern(const Urho3D::String &value) {
+    auto itr = mStringIds.Find(value);
+    if (itr != mStringIds.End()) {
+      return itr->second_;
+    }
+    auto id = static_cast<std::uint32_t>(mStrings.size());
+    mStringIds[value] = id;
+    mStrings.push_back(value);
+    return id;
+  }
+
+  void AddColumns(const char *name, const std::vector<std::uint32_t> &sizes,
+                  const std::vector<std::uint32_t> &indices,
+                  const std::vector<std::vector<unsigned char>> &columns) {
+    if (indices.empty()) {
+      return;
+    }
+    SnapshotType type{};
+    std::strncpy(type.name, name, TYPE_NAME_SIZE - 1);
+    type.fieldCount = static_cast<std::uint32_t>(sizes.size());
+    type.count = static_cast<std::uint32_t>(indices.size());
+    type.offset = Align();
+    Append(sizes.data(), sizes.size() * sizeof(std::uint32_t));
+    Align();
+    Append(indices.data(), indices.size() * sizeof(std::uint32_t));
+    for (const auto &column : columns) {
+      Align();
+      Append(column.data(), column.size());
+    }
+    mTypes.push_back(type);
+  }
+
+  /// Adds the string table, the type table and the header.
+  const std::vector<unsigned char> &Finish() {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = WorldSnapshot::VERSION;
+    header.entityCount = static_cast<std::uint32_t>(mSaved.size());
+    header.typeCount = static_cast<std::uint32_t>(mTypes.size());
+    header.stringCount = static_cast<std::uint32_t>(mStrings.size());
+
+    header.stringsOffset = Align();
+    std::uint32_t offset = 0;
+    for (const auto &value : mStrings) {
+      Append(&offset, sizeof(offset));
+      offset += value.Length();
+    }
+    Append(&offset, sizeof(offset));
+    for (const auto &value : mStrings) {
+      Append(value.CString(), value.Length());
+    }
+
+    header.typesOffset = Align();
+    Append(mTypes.data(), mTypes.size() * sizeof(SnapshotType));
+    header.fileSize = mData.size();
+    std::memcpy(mData.data(), &header, sizeof(header));
+    return mData;
+  }
+
+private:
+  std::uint64_t Align() {
+    mData.resize(AlignUp(mData.size()));
+    return mData.size();
+  }
+
+  void Append(const void *data, std::size_t size) {
+    auto bytes = static_cast<const unsigned char *>(data);
+    mData.insert(mData.end(), bytes, bytes + size);
+  }
+
+  entityx::EntityManager &mEntities;
+  const std::vector<entityx::Entity> &mSaved;
+  /// Index in the snapshot of every saved entity, by entity index.
+  std::vector<std::uint32_t> mIndices;
+  Urho3D::HashMap<Urho3D::String, std::uint32_t> mStringIds;
+  std::vector<Urho3D::String> mStrings;
+  std::vector<SnapshotType> mTypes;
+  std::vector<unsigned char> mData;
+};
+
+/// The columns of one type in a mapped snapshot.
+struct LoadedColumns {
+  std::uint32_t GetIndex(std::uint32_t row) const {
+    std::uint32_t index;
+    std::memcpy(&index, indices + row * sizeof(index), sizeof(index));
+    return index;
+  }
+
+  const struct ColumnType *type;
+  std::uint32_t count;
+  const unsigned char *indices;
+  std::vector<const unsigned char *> fields;
+};
+
+class SnapshotReader {
+public:
+  SnapshotReader(entityx::EntityManager &entities,
+                 const std::vector<entityx::Entity> &loaded,
+                 std::size_t firstLoaded,
+                 const std::vector<Urho3D::String> &strings)
+      : mEntities(entities), mLoaded(loaded), mFirstLoaded(firstLoaded),
+        mStrings(strings) {}
+
+  /// Entities the component pools have to make room for.
+  std::size_t GetCapacity() const { return mEntities.capacity(); }
+
+  std::size_t GetCount() const { return mLoaded.size() - mFirstLoaded; }
+
+  entityx::Entity GetEntity(std::uint32_t index) const {
+    return index < GetCount() ? mLoaded[mFirstLoaded + index]
+                              : entityx::Entity();
+  }
+
+  const Urho3D::String &GetString(std::uint32_t id) const {
+    return id < mStrings.size() ? mStrings[id] : Urho3D::String::EMPTY;
+  }
+
+private:
+  entityx::EntityManager &mEntities;
+  const std::vector<entityx::Entity> &mLoaded;
+  std::size_t mFirstLoaded;
+  const std::vector<Urho3D::String> &mStrings;
+};
+
+/**
+ * How a field is stored in its column. Trivial values are copied as they
+ * are, anything referring to memory needs a specialisation.
+ */
+template <typename T> struct SnapshotField {
+  static_assert(std::is_trivially_destructible<T>::value,
+                "Stored as raw bytes, give the type a SnapshotField");
+  using Stored = T;
+
+  static Stored Save(const T &value, SnapshotWriter &) { return value; }
+
+  static void Load(T &value, const Stored &stored, const SnapshotReader &) {
+    value = stored;
+  }
+};
+
+template <> struct SnapshotField<bool> {
+  using Stored = std::uint8_t;
+
+  static Stored Save(bool value, SnapshotWriter &) { return value ? 1 : 0; }
+
+  static void Load(bool &value, Stored stored, const SnapshotReader &) {
+    value = stored != 0;
+  }
+};
+
+template <> struct SnapshotField<Urho3D::String> {
+  /// Index in the string table.
+  using Stored = std::uint32_t;
+
+  static Stored Save(const Urho3D::String &value, SnapshotWriter &writer) {
+    return writer.Intern(value);
+  }
+
+  static void Load(Urho3D::String &value, Stored stored,
+                   const SnapshotReader &reader) {
+    value = reader.GetString(stored);
+  }
+};
+
+template <> struct SnapshotField<entityx::Entity::Id> {
+  /// Index of the entity in the snapshot.
+  using Stored = std::uint32_t;
+
+  static Stored Save(entityx::Entity::Id value, SnapshotWriter &writer) {
+    return writer.GetIndex(value);
+  }
+
+  static void Load(entityx::Entity::Id &value, Stored stored,
+                   const SnapshotReader &reader) {
+    auto entity = reader.GetEntity(stored);
+    value = entity.valid() ? entity.id() : entityx::Entity::INVALID;
+  }
+};
+
+template <> struct SnapshotField<Urho3D::Plane> {
+  // NOTE: The plane's absolute normal is derived from the rest
+  using Stored = Urho3D::Vector4;
+
+  static Stored Save(const Urho3D::Plane &value, SnapshotWriter &) {
+    return value.ToVector4();
+  }
+
+  static void Load(Urho3D::Plane &value, const Stored &stored,
+                   const SnapshotReader &) {
+    value.Define(stored);
+  }
+};
+
+/**
+ * The fields of a component type that are stored, in column order. `Create`
+ * makes the component the loaded fields get written into.
+ */
+template <typename C> struct SnapshotComponent;
+
+template <> struct SnapshotComponent<AngularVelocity> {
+  static AngularVelocity Create() { return AngularVelocity(); }
+  template <typename F> static void Fields(AngularVelocity &c, F &&field) {
+    field(c.value);
+  }
+};
+
+template <> struct SnapshotComponent<Camera> {
+  static Camera Create() { return Camera(); }
+  template <typename F> static void Fields(Camera &c, F &&field) {
+    field(c.nearClip);
+    field(c.farClip);
+    field(c.fov);
+    field(c.orthoSize);
+    field(c.aspectRatio);
+    field(c.fillMode);
+    field(c.zoom);
+    field(c.lodBias);
+    field(c.viewMask);
+    field(c.viewOverrideFlags);
+    field(c.isOrthographic);
+    field(c.isAutoAspectRatio);
+    field(c.projectionOffset);
+    field(c.useReflection);
+    field(c.clipPane);
+    field(c.flipVertical);
+  }
+};
+
+template <> struct SnapshotComponent<Direction> {
+  static Direction Create() { return Direction(); }
+  template <typename F> static void Fields(Direction &c, F &&field) {
+    field(c.value);
+  }
+};
+
+template <> struct SnapshotComponent<Light> {
+  static Light Create() { return Light(); }
+  template <typename F> static void Fields(Light &c, F &&field) {
+    field(c.type);
+    field(c.brightness);
+    field(c.range);
+    field(c.fov);
+    field(c.temperature);
+    field(c.radius);
+    field(c.length);
+    field(c.color);
+    field(c.castShadows);
+  }
+};
+
+template <> struct SnapshotComponent<Material> {
+  static Material Create() { return Material(Urho3D::String::EMPTY); }
+  template <typename F> static void Fields(Material &c, F &&field) {
+    field(c.name);
+  }
+};
+
+template <> struct SnapshotComponent<Name> {
+  static Name Create() { return Name(Urho3D::String::EMPTY); }
+  template <typename F> static void Fields(Name &c, F &&field) {
+    field(c.value);
+  }
+};
+
+template <> struct SnapshotComponent<Position> {
+  static Position Create() { return Position(); }
+  template <typename F> static void Fields(Position &c, F &&field) {
+    field(c.value);
+  }
+};
+
+template <> struct SnapshotComponent<Renderable> {
+  static Renderable Create() { return Renderable(); }
+  template <typename F> static void Fields(Renderable &c, F &&field) {
+    field(c.parentEntityId);
+  }
+};
+
+template <> struct SnapshotComponent<Scale> {
+  static Scale Create() { return Scale(); }
+  template <typename F> static void Fields(Scale &c, F &&field) {
+    field(c.value);
+  }
+};
+
+template <> struct SnapshotComponent<Skybox> {
+  static Skybox Create() {
+    return Skybox(Urho3D::String::EMPTY, Urho3D::String::EMPTY);
+  }
+  template <typename F> static void Fields(Skybox &c, F &&field) {
+    field(c.model);
+    field(c.material);
+  }
+};
+
+template <> struct SnapshotComponent<SoundListener> {
+  static SoundListener Create() {
+    return SoundListener(entityx::Entity::INVALID);
+  }
+  template <typename F> static void Fields(SoundListener &c, F &&field) {
+    field(c.listenerId);
+  }
+};
+
+template <> struct SnapshotComponent<StaticModel> {
+  static StaticModel Create() {
+    return StaticModel(Urho3D::String::EMPTY, Urho3D::String::EMPTY);
+  }
+  template <typename F> static void Fields(StaticModel &c, F &&field) {
+    field(c.model);
+    field(c.material);
+    field(c.castShadows);
+  }
+};
+
+template <> struct SnapshotComponent<Velocity> {
+  static Velocity Create() { return Velocity(); }
+  template <typename F> static void Fields(Velocity &c, F &&field) {
+    field(c.value);
+  }
+};
+
+/// A component type or tag as far as snapshots are concerned.
+struct ColumnType {
+  /// Stored in the snapshot, renaming a type drops it from existing ones.
+  const char *name;
+  bool (*has)(entityx::Entity entity, const TagSet &tags);
+  /// Null for types whose entities are left out of snapshots.
+  void (*save)(const char *name, SnapshotWriter &writer, const TagSet &tags);
+  void (*getFieldSizes)(std::vector<std::uint32_t> &sizes);
+  void (*load)(const SnapshotReader &reader, const LoadedColumns &columns,
+               TagSet &tags);
+};
+
+template <typename C> bool HasComponent(entityx::Entity entity, const TagSet &) {
+  return entity.has_component<C>();
+}
+
+template <typename C> void GetFieldSizes(std::vector<std::uint32_t> &sizes) {
+  auto component = SnapshotComponent<C>::Create();
+  SnapshotComponent<C>::Fields(component, [&sizes](auto &field) {
+    using Field = SnapshotField<std::decay_t<decltype(field)>>;
+    sizes.push_back(sizeof(typename Field::Stored));
+  });
+}
+
+template <typename C>
+void SaveComponent(const char *name, SnapshotWriter &writer, const TagSet &) {
+  std::vector<std::uint32_t> sizes;
+  GetFieldSizes<C>(sizes);
+  std::vector<std::uint32_t> indices;
+  std::vector<std::vector<unsigned char>> columns(sizes.size());
+  const auto &saved = writer.GetSaved();
+  for (std::uint32_t i = 0; i < saved.size(); ++i) {
+    auto entity = saved[i];
+    auto component = entity.component<C>();
+    if (!component) {
+      continue;
+    }
+    indices.push_back(i);
+    unsigned column = 0;
+    SnapshotComponent<C>::Fields(*component, [&](auto &field) {
+      using Field = SnapshotField<std::decay_t<decltype(field)>>;
+      AppendBytes(columns[column++], Field::Save(field, writer));
+    });
+  }
+  writer.AddColumns(name, sizes, indices, columns);
+}
+
+template <typename C>
+void LoadComponent(const SnapshotReader &reader, const LoadedColumns &columns,
+                   TagSet &) {
+  bool isReserved = false;
+  for (std::uint32_t row = 0; row < columns.count; ++row) {
+    auto entity = reader.GetEntity(columns.GetIndex(row));
+    if (!entity.valid()) {
+      continue;
+    }
+    auto component = SnapshotComponent<C>::Create();
+    unsigned column = 0;
+    SnapshotComponent<C>::Fields(component, [&](auto &field) {
+      using Field = SnapshotField<std::decay_t<decltype(field)>>;
+      // NOTE: Copied byte wise, Urho3D's math types are not trivially
+      // copyable on paper
+      typename Field::Stored stored;
+      std::memcpy(static_cast<void *>(&stored),
+                  columns.fields[column++] + row * sizeof(stored),
+                  sizeof(stored));
+      Field::Load(field, stored, reader);
+    });
+    entity.assign<C>(std::move(component));
+    if (!isReserved) {
+      // NOTE: Pools are indexed by entity index, see
+      // GameState::ReserveComponents. Only the pool of this state grows, the
+      // global reservation would stick to every state created afterwards.
+      ComponentPools::ReserveFor<C>(entity, reader.GetCapacity());
+      isReserved = true;
+    }
+  }
+}
+
+template <typename T> bool HasTag(entityx::Entity entity, const TagSet &tags) {
+  return tags.Has<T>(entity);
+}
+
+void GetNoFieldSizes(std::vector<std::uint32_t> &) {}
+
+template <typename T>
+void SaveTag(const char *name, SnapshotWriter &writer, const TagSet &tags) {
+  std::vector<std::uint32_t> indices;
+  const auto &saved = writer.GetSaved();
+  for (std::uint32_t i = 0; i < saved.size(); ++i) {
+    if (tags.Has<T>(saved[i])) {
+      indices.push_back(i);
+    }
+  }
+  writer.AddColumns(name, {}, indices, {});
+}
+
+template <typename T>
+void LoadTag(const SnapshotReader &reader, const LoadedColumns &columns,
+             TagSet &tags) {
+  for (std::uint32_t row = 0; row < columns.count; ++row) {
+    auto entity = reader.GetEntity(columns.GetIndex(row));
+    if (entity.valid()) {
+      tags.Set<T>(entity);
+    }
+  }
+}
+
+template <typename C> ColumnType ComponentColumns(const char *name) {
+  return ColumnType{name, &HasComponent<C>, &SaveComponent<C>,
+                    &GetFieldSizes<C>, &LoadComponent<C>};
+}
+
+template <typename T> ColumnType TagColumns(const char *name) {
+  return ColumnType{name, &HasTag<T>, &SaveTag<T>, &GetNoFieldSizes,
+                    &LoadTag<T>};
+}
+
+/// Entities having one of these are left out.
+template <typename C> ColumnType TransientColumns(const char *name) {
+  return ColumnType{name, &HasComponent<C>, nullptr, nullptr, nullptr};
+}
+
+// NOTE: Hierarchy is rebuilt from Renderable and Viewport points at a render
+// path, neither is stored
+const std::vector<ColumnType> &GetColumnTypes() {
+  static const std::vector<ColumnType> types = {
+      ComponentColumns<AngularVelocity>("AngularVelocity"),
+      ComponentColumns<Camera>("Camera"),
+      ComponentColumns<Direction>("Direction"),
+      ComponentColumns<Light>("Light"),
+      ComponentColumns<Material>("Material"),
+      ComponentColumns<Name>("Name"),
+      ComponentColumns<Position>("Position"),
+      ComponentColumns<Renderable>("Renderable"),
+      ComponentColumns<Scale>("Scale"),
+      ComponentColumns<Skybox>("Skybox"),
+      ComponentColumns<SoundListener>("SoundListener"),
+      ComponentColumns<StaticModel>("StaticModel"),
+      ComponentColumns<Velocity>("Velocity"),
+      TagColumns<Sleeping>("Tag:Sleeping"),
+      TagColumns<Static>("Tag:Static"),
+      TransientColumns<BackgroundMusic>("BackgroundMusic"),
+      TransientColumns<Sound>("Sound"),
+  };
+  return types;
+}
+
+const ColumnType *FindColumnType(const char *name) {
+  for (const auto &type : GetColumnTypes()) {
+    if (std::strcmp(type.name, name) == 0) {
+      return &type;
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+WorldSnapshot::WorldSnapshot(entityx::EntityManager &entities, TagSet &tags)
+    : mEntities(entities), mTags(tags) {}
+
+bool WorldSnapshot::Save(const Urho3D::String &path) {
+  const auto &types = GetColumnTypes();
+  std::vector<entityx::Entity> saved;
+  saved.reserve(mEntities.size());
+  for (std::uint32_t index = 0; index < mEntities.capacity(); ++index) {
+    auto id = mEntities.create_id(index);
+    // NOTE: The current version of a free slot is valid too, but it has no
+    // components
+    if (!mEntities.valid(id)) {
+      continue;
+    }
+    auto entity = mEntities.get(id);
+    if (entity.component_mask().none()) {
+      continue;
+    }
+    // NOTE: Every saved entity shows up in at least one column, which is what
+    // bounds the entity count when loading
+    bool isTransient = false;
+    bool isStored = false;
+    for (const auto &type : types) {
+      if (type.has(entity, mTags)) {
+        isTransient |= !type.save;
+        isStored |= type.save != nullptr;
+      }
+    }
+    if (isStored && !isTransient) {
+      saved.push_back(entity);
+    }
+  }
+
+  SnapshotWriter writer(mEntities, saved);
+  for (const auto &type : types) {
+    if (type.save) {
+      type.save(type.name, writer, mTags);
+    }
+  }
+  const auto &data = writer.Finish();
+
+  auto file = std::fopen(path.CString(), "wb");
+  if (!file) {
+    GAME_LOGERRORF("Could not open '%s' for the snapshot", path.CString());
+    return false;
+  }
+  bool isWritten = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  isWritten = std::fclose(file) == 0 && isWritten;
+  if (!isWritten) {
+    GAME_LOGERRORF("Could not write the snapshot to '%s'", path.CString());
+    return false;
+  }
+  GAME_LOGINFOF("Saved %u entities to '%s', %u KiB",
+                static_cast<unsigned>(saved.size()), path.CString(),
+                static_cast<unsigned>(data.size() / 1024));
+  return true;
+}
+
+bool WorldSnapshot::Load(const Urho3D::String &path,
+                         std::vector<entityx::Entity> &loaded) {
+  MappedFile file;
+  if (!file.Open(path.CString())) {
+    GAME_LOGERRORF("Could not open the snapshot '%s'", path.CString());
+    return false;
+  }
+  const auto data = file.GetData();
+  const std::uint64_t size = file.GetSize();
+
+  // Check everything before creating a single entity
+  SnapshotHeader header;
+  if (size < sizeof(header)) {
+    GAME_LOGERRORF("'%s' is not a snapshot", path.CString());
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != VERSION) {
+    GAME_LOGERRORF("'%s' is not a snapshot of version %u", path.CString(),
+                   VERSION);
+    return false;
+  }
+  const std::uint64_t stringsLength =
+      (std::uint64_t(header.stringCount) + 1) * sizeof(std::uint32_t);
+  if (header.fileSize != size ||
+      !Fits(header.typesOffset,
+            std::uint64_t(header.typeCount) * sizeof(SnapshotType), size) ||
+      !Fits(header.stringsOffset, stringsLength, size)) {
+    GAME_LOGERRORF("The snapshot '%s' is truncated or corrupt",
+                   path.CString());
+    return false;
+  }
+
+  std::vector<LoadedColumns> typeColumns;
+  // Rows of every column, unknown ones included
+  std::uint64_t rowCount = 0;
+  std::vector<std::uint32_t> sizes;
+  std::vector<std::uint32_t> expectedSizes;
+  for (std::uint32_t i = 0; i < header.typeCount; ++i) {
+    SnapshotType type;
+    std::memcpy(&type, data + header.typesOffset + i * sizeof(SnapshotType),
+                sizeof(type));
+    type.name[TYPE_NAME_SIZE - 1] = '\0';
+
+    LoadedColumns columns;
+    columns.count = type.count;
+    auto offset = type.offset;
+    // NOTE: Checked before the sizes are allocated, the count may be garbage
+    bool fits = Fits(offset,
+                     std::uint64_t(type.fieldCount) * sizeof(std::uint32_t),
+                     size);
+    if (fits) {
+      sizes.resize(type.fieldCount);
+      std::memcpy(sizes.data(), data + offset,
+                  sizes.size() * sizeof(std::uint32_t));
+      offset = AlignUp(offset + sizes.size() * sizeof(std::uint32_t));
+      fits = Fits(offset, std::uint64_t(type.count) * sizeof(std::uint32_t),
+                  size);
+      columns.indices = data + offset;
+      offset += std::uint64_t(type.count) * sizeof(std::uint32_t);
+    }
+    for (std::uint32_t field = 0; fits && field < type.fieldCount; ++field) {
+      offset = AlignUp(offset);
+      auto length = std::uint64_t(type.count) * sizes[field];
+      fits = Fits(offset, length, size);
+      columns.fields.push_back(data + offset);
+      offset += length;
+    }
+    if (!fits) {
+      GAME_LOGERRORF("The '%s' columns of the snapshot '%s' are truncated",
+                     type.name, path.CString());
+      return false;
+    }
+    rowCount += type.count;
+
+    columns.type = FindColumnType(type.name);
+    if (!columns.type || !columns.type->load) {
+      GAME_LOGWARNINGF("Skipping the unknown '%s' columns of the snapshot '%s'",
+                       type.name, path.CString());
+      continue;
+    }
+    expectedSizes.clear();
+    columns.type->getFieldSizes(expectedSizes);
+    if (sizes != expectedSizes) {
+      GAME_LOGWARNINGF("Skipping the '%s' columns of the snapshot '%s', its "
+                       "fields have changed",
+                       type.name, path.CString());
+      continue;
+    }
+    typeColumns.push_back(std::move(columns));
+  }
+
+  // Every saved entity is in a column, more entities than rows cannot be
+  // right. The rows are in the file, so this bounds the count by its size too.
+  if (header.entityCount > rowCount) {
+    GAME_LOGERRORF("The snapshot '%s' claims %u entities but only holds %u "
+                   "rows",
+                   path.CString(), header.entityCount,
+                   static_cast<unsigned>(rowCount));
+    return false;
+  }
+
+  std::vector<Urho3D::String> strings(header.stringCount);
+  const auto offsets = data + header.stringsOffset;
+  const auto characters = header.stringsOffset + stringsLength;
+  std::uint32_t begin;
+  std::memcpy(&begin, offsets, sizeof(begin));
+  for (std::uint32_t i = 0; i < header.stringCount; ++i) {
+    std::uint32_t end;
+    std::memcpy(&end, offsets + (i + 1) * sizeof(end), sizeof(end));
+    if (end < begin || !Fits(characters + begin, end - begin, size)) {
+      GAME_LOGERRORF("The strings of the snapshot '%s' are corrupt",
+                     path.CString());
+      return false;
+    }
+    strings[i] = Urho3D::String(
+        reinterpret_cast<const char *>(data + characters + begin),
+        end - begin);
+    begin = end;
+  }
+
+  const auto firstLoaded = loaded.size();
+  loaded.reserve(firstLoaded + header.entityCount);
+  for (std::uint32_t i = 0; i < header.entityCount; ++i) {
+    loaded.push_back(mEntities.create());
+  }
+  SnapshotReader reader(mEntities, loaded, firstLoaded, strings);
+  for (const auto &columns : typeColumns) {
+    columns.type->load(reader, columns, mTags);
+  }
+  GAME_LOGINFOF("Loaded %u entities from '%s'", header.entityCount,
+                path.CString());
+  return true;
+}
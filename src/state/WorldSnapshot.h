@@ -0,0 +1,75 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_WORLDSNAPSHOT_H
+#define NINPOTEST_WORLDSNAPSHOT_H
+
+#include <entityx/Entity.h>
+
+#include <Urho3D/Container/Str.h>
+
+#include <vector>
+
+#include "../common/TagSet.h"
+
+/**
+ * Saves the entities of a world to a binary file and adds them back to a
+ * world later.
+ *
+ * The file holds a set of columns for every component type: the indices of
+ * the entities having the component, then one column per field. Strings are
+ * stored once in a string table and entity IDs as indices of entities in the
+ * snapshot. Component types are looked up by name, so a type missing from
+ * the code is skipped, and so is a type whose fields changed, with a warning.
+ * Bump VERSION when the layout of the file itself changes.
+ *
+ * Only plain data is stored, the component types are listed in
+ * WorldSnapshot.cpp. Entities playing a sound or the background music belong
+ * to the running game and are left out, as are entities none of whose
+ * components are stored.
+ */
+class WorldSnapshot {
+public:
+  static constexpr unsigned VERSION = 1;
+
+  WorldSnapshot(entityx::EntityManager &entities, TagSet &tags);
+
+  /// Builds the whole file in memory and writes it in one go.
+  bool Save(const Urho3D::String &path);
+
+  /**
+   * Maps the file and creates its entities, appending them to `loaded` in the
+   * order they were saved. Nothing is created if the file is not a valid
+   * snapshot.
+   *
+   * NOTE: Only the components are restored. The Hierarchy links and the scene
+   * instances are up to the caller, see GameState::LoadSnapshot.
+   */
+  bool Load(const Urho3D::String &path, std::vector<entityx::Entity> &loaded);
+
+private:
+  entityx::EntityManager &mEntities;
+  TagSet &mTags;
+};
+
+#endif // NINPOTEST_WORLDSNAPSHOT_H
@@ -26,21 +26,29 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../components/AngularVelocity.h"
 #include "../components/Direction.h"
 #include "../components/Position.h"
+#include "../components/Tags.h"
 #include "../components/Velocity.h"
 
+MovementSystem::MovementSystem(TagSet &tags) : mTags(tags) {}
+
 void MovementSystem::update(entityx::EntityManager &es,
                             entityx::EventManager &events,
                             entityx::TimeDelta dt) {
-  es.each<Direction, AngularVelocity>([dt](entityx::Entity entity,
-                                           Direction &direction,
-                                           AngularVelocity &velocity) {
-    Urho3D::Quaternion deltaRotation = Urho3D::Quaternion(
-        velocity.value.x_ * dt, velocity.value.y_ * dt, velocity.value.z_ * dt);
-    direction.Rotate(deltaRotation);
-  });
-
-  es.each<Position, Velocity>(
-      [dt](entityx::Entity entity, Position &position, Velocity &velocity) {
+  // NOTE: Sleeping entities are masked out of the tag columns before any
+  // component gets looked at
+  mTags.Each<Direction, AngularVelocity>(
+      TagList<>(), TagList<Sleeping>(), es,
+      [dt](entityx::Entity, Direction &direction,
+           AngularVelocity &velocity) {
+        Urho3D::Quaternion deltaRotation =
+            Urho3D::Quaternion(velocity.value.x_ * dt, velocity.value.y_ * dt,
+                               velocity.value.z_ * dt);
+        direction.Rotate(deltaRotation);
+      });
+
+  mTags.Each<Position, Velocity>(
+      TagList<>(), TagList<Sleeping>(), es,
+      [dt](entityx::Entity, Position &position, Velocity &velocity) {
         position.value += velocity.value * dt;
       });
 }
@@ -21,9 +21,16 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include <entityx/System.h>
 
+#include "../common/TagSet.h"
+
 class MovementSystem : public entityx::System<MovementSystem> {
 public:
+  explicit MovementSystem(TagSet &tags);
+
   void update(entityx::EntityManager &es, entityx::EventManager &events, entityx::TimeDelta dt) override;
+
+private:
+  TagSet &mTags;
 };
 
 #endif //NINPOTEST_MOVEMENTSYSTEM_H
@@ -34,19 +34,26 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../components/Position.h"
 #include "../components/Renderable.h"
 #include "../components/Scale.h"
+#include "../components/Tags.h"
+#include "../state/FrameTracer.h"
 
 UrhoSystem::UrhoSystem(Urho3D::Context *context,
-                       Urho3D::SharedPtr<Urho3D::Scene> scene)
-    : mRenderer(*context->GetSubsystem<Urho3D::Renderer>()),
+                       Urho3D::SharedPtr<Urho3D::Scene> scene, TagSet &tags,
+                       const VoiceSettings &voiceSettings)
+    : mRenderer(context->GetSubsystem<Urho3D::Renderer>()),
       mResources(*context->GetSubsystem<Urho3D::ResourceCache>()),
       mAudio(*context->GetSubsystem<Urho3D::Audio>()), mScene(scene),
-      mNodes(*scene), mLights(*scene, mNodes),
+      mTags(tags), mNodes(*scene), mLights(*scene, mNodes),
       mStaticModels(*scene, mNodes, mResources),
       mCameras(*scene, mNodes, context, mRenderer),
       mSoundListeners(*scene, mNodes, mAudio),
       mBackgroundInstances(*scene, mResources),
-      mSounds(*scene, mNodes, mResources),
-      mSkyboxes(*scene, mNodes, mResources) {}
+      mSounds(*scene, mNodes, mResources, &mAudio, voiceSettings),
+      mSkyboxes(*scene, mNodes, mResources) {
+  // NOTE: An entity that stops being static may change, it has to be synced
+  // again once it is static again
+  mTags.Link<Static, StaticSynced>();
+}
 
 void UrhoSystem::configure(entityx::EventManager &eventManager) {
   mNodes.Configure(eventManager);
@@ -58,28 +65,59 @@ void UrhoSystem::configure(entityx::EventManager &eventManager) {
   mSounds.Configure(eventManager);
   mSkyboxes.Configure(eventManager);
   eventManager.subscribe<entityx::EntityDestroyedEvent>(*this);
+  eventManager.subscribe<SubtreeDestroyedEvent>(*this);
 }
 
 void UrhoSystem::update(entityx::EntityManager &entities,
                         entityx::EventManager &events, entityx::TimeDelta dt) {
-  entities.each<Renderable>(
-      [&, this](entityx::Entity entity, Renderable &renderable) {
-        mCameras.Sync(entity, entities);
-        mNodes.Sync(entity, entities);
-        mStaticModels.Sync(entity, entities);
-        mLights.Sync(entity, entities);
-        mBackgroundInstances.Sync(entity, entities);
-        mSounds.Sync(entity, entities);
-        mSoundListeners.Sync(entity, entities);
-        mSounds.Sync(entity, entities);
-        mSkyboxes.Sync(entity, entities);
-      });
+  {
+    // NOTE: One scope for the whole pass, a scope per entity would fill the
+    // trace buffer within a few frames
+    TRACE_SCOPE("UrhoSystem::Sync");
+    entities.each<Renderable>(
+        [&, this](entityx::Entity entity, Renderable &renderable) {
+          bool isStatic = mTags.Has<Static>(entity);
+          if (isStatic && mTags.Has<StaticSynced>(entity)) {
+            return;
+          }
+          mCameras.Sync(entity, entities);
+          mNodes.Sync(entity, entities);
+          mStaticModels.Sync(entity, entities);
+          mLights.Sync(entity, entities);
+          mBackgroundInstances.Sync(entity, entities);
+          mSounds.Sync(entity, entities);
+          mSoundListeners.Sync(entity, entities);
+          mSounds.Sync(entity, entities);
+          mSkyboxes.Sync(entity, entities);
+          if (isStatic && mNodes.GetIfExists(entity)) {
+            mTags.Set<StaticSynced>(entity);
+          }
+        });
+  }
+  {
+    TRACE_SCOPE("UrhoSystem::UpdateVoices");
+    mSounds.UpdateVoices(dt);
+  }
+  {
+    TRACE_SCOPE("BackgroundMusic::Update");
+    mBackgroundInstances.Update(dt);
+  }
 }
 
 void UrhoSystem::receive(const entityx::EntityDestroyedEvent &event) {
   auto entity = event.entity;
   auto node = mNodes.GetIfExists(entity);
-  if (node) {
-    mScene->RemoveChild(node);
+  if (node && node->GetScene()) {
+    node->Remove();
+  }
+}
+
+void UrhoSystem::receive(const SubtreeDestroyedEvent &event) {
+  // Removing the root takes the nodes of every descendant with it. The
+  // providers skip instances that have already left the scene, so this is the
+  // only scene graph removal for the whole subtree.
+  auto node = mNodes.GetIfExists(event.root);
+  if (node && node->GetScene()) {
+    node->Remove();
   }
 }
@@ -37,6 +37,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../components/Renderable.h"
 #include "../components/StaticModel.h"
 
+#include "../common/TagSet.h"
+#include "../events/HierarchyEvents.h"
+
 #include "providers/scene/BackgroundMusicInstances.h"
 #include "providers/scene/CameraInstances.h"
 #include "providers/scene/LightInstances.h"
@@ -50,7 +53,8 @@ class UrhoSystem : public entityx::System<UrhoSystem>,
                      public entityx::Receiver<UrhoSystem> {
 public:
   UrhoSystem(Urho3D::Context *context,
-               Urho3D::SharedPtr<Urho3D::Scene> scene);
+               Urho3D::SharedPtr<Urho3D::Scene> scene, TagSet &tags,
+               const VoiceSettings &voiceSettings = VoiceSettings());
 
   void configure(entityx::EventManager &eventManager) override;
 
@@ -59,11 +63,20 @@ public:
 
   void receive(const entityx::EntityDestroyedEvent &event);
 
+  void receive(const SubtreeDestroyedEvent &event);
+
+  VoiceManager &GetVoices() { return mSounds.GetVoices(); }
+
 private:
-  Urho3D::Renderer &mRenderer;
+  /// Set on static entities once their scene instances are in sync.
+  struct StaticSynced {};
+
+  // NOTE: Null when running headless
+  Urho3D::Renderer *mRenderer;
   Urho3D::ResourceCache &mResources;
   Urho3D::Audio &mAudio;
   Urho3D::SharedPtr<Urho3D::Scene> mScene;
+  TagSet &mTags;
   NodeInstances mNodes;
   LightInstances mLights;
   StaticModelInstances mStaticModels;
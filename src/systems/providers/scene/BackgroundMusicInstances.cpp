@@ -25,51 +25,113 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <Urho3D/Audio/SoundSource.h>
 
+#include <algorithm>
+
+namespace {
+/// Seconds of audio kept decoded ahead of playback.
+constexpr float STREAM_AHEAD_TIME = 0.25f;
+} // namespace
+
 BackgroundMusicInstances::BackgroundMusicInstances(
     Urho3D::Scene &scene, Urho3D::ResourceCache &resources)
-    : SceneInstances(scene, "BackgroundMusic"), mResources(resources) {}
+    : SceneInstances(scene, "BackgroundMusic"), mResources(resources),
+      mCurrentDeck(0), mCrossfadeTime(0.0f) {}
+
+void BackgroundMusicInstances::Update(float timeStep) {
+  for (auto &deck : mDecks) {
+    if (!deck.stream) {
+      continue;
+    }
+    deck.stream->Fill(STREAM_AHEAD_TIME);
+    if (deck.gain != deck.targetGain) {
+      auto step = mCrossfadeTime > 0.0f ? timeStep / mCrossfadeTime : 1.0f;
+      deck.gain = deck.gain < deck.targetGain
+                      ? std::min(deck.targetGain, deck.gain + step)
+                      : std::max(deck.targetGain, deck.gain - step);
+      deck.source->SetGain(deck.gain);
+      FrameCounters::Add(COUNTER_URHO_SETTERS);
+    }
+    if ((deck.gain == 0.0f && deck.targetGain == 0.0f) ||
+        deck.stream->IsFinished()) {
+      StopDeck(deck);
+    }
+  }
+}
 
 Urho3D::SharedPtr<Urho3D::SoundSource>
 BackgroundMusicInstances::Create(entityx::Entity entity,
                                  const BackgroundMusic &component,
                                  entityx::EntityManager &entities) {
-  auto soundSource = mScene.CreateComponent<Urho3D::SoundSource>();
-  if (PlayMusic(*soundSource, component.value)) {
-    return Urho3D::SharedPtr(soundSource);
+  for (auto &deck : mDecks) {
+    deck.source = mScene.CreateComponent<Urho3D::SoundSource>();
+    deck.source->SetSoundType(Urho3D::SOUND_MUSIC);
+  }
+  mCurrentDeck = 0;
+  mCrossfadeTime = 0.0f;
+  if (PlayMusic(mDecks[mCurrentDeck], component.value)) {
+    return mDecks[mCurrentDeck].source;
   }
   // Clean up
-  mScene.RemoveComponent(soundSource);
+  for (auto &deck : mDecks) {
+    mScene.RemoveComponent(deck.source);
+    deck.source.Reset();
+  }
   return Urho3D::SharedPtr<Urho3D::SoundSource>{};
 }
 
 void BackgroundMusicInstances::SyncFromData(entityx::Entity entity,
                                             Urho3D::SoundSource &instance,
                                             const BackgroundMusic &data) {
-  if (mSound->GetName() == data.value) {
+  if (mDecks[mCurrentDeck].file == data.value) {
     return;
   }
-  instance.Stop();
-  PlayMusic(instance, data.value);
+  // Fade the playing track out on its deck while the new one fades in on the
+  // other
+  mDecks[mCurrentDeck].targetGain = 0.0f;
+  mCurrentDeck = 1 - mCurrentDeck;
+  mCrossfadeTime = data.crossfadeTime;
+  auto &deck = mDecks[mCurrentDeck];
+  StopDeck(deck);
+  PlayMusic(deck, data.value);
 }
 
 bool BackgroundMusicInstances::DestroyInstance(Urho3D::SoundSource &instance) {
-  instance.Stop();
-  mSound.Reset();
-  mScene.RemoveComponent(&instance);
+  for (auto &deck : mDecks) {
+    StopDeck(deck);
+    mScene.RemoveComponent(deck.source);
+    deck.source.Reset();
+  }
   return true;
 }
 
-bool BackgroundMusicInstances::PlayMusic(Urho3D::SoundSource &soundSource,
-                                         const Urho3D::String file) {
-  mSound = mResources.GetResource<Urho3D::Sound>(file);
-  if (!mSound) {
-    URHO3D_LOGERRORF("Failed to load background music from file: %s",
-                     file.CString());
+bool BackgroundMusicInstances::PlayMusic(Deck &deck,
+                                         const Urho3D::String &file) {
+  // Remember the file even if it fails to play, so it isn't retried on every
+  // sync
+  deck.file = file;
+  Urho3D::SharedPtr<MusicStream> stream(new MusicStream());
+  FrameCounters::Add(COUNTER_RESOURCE_LOOKUPS);
+  if (!stream->Open(mResources.GetFile(file), true)) {
+    GAME_LOGERRORF("Failed to stream background music from file: %s",
+                   file.CString());
     return false;
   }
-  mSound->SetName(file);
-  mSound->SetLooped(true);
-  soundSource.SetSoundType(Urho3D::SOUND_MUSIC);
-  soundSource.Play(mSound);
+  // Only the first frames are decoded before playback starts
+  stream->Fill(STREAM_AHEAD_TIME);
+  deck.stream = stream;
+  deck.gain = mCrossfadeTime > 0.0f ? 0.0f : 1.0f;
+  deck.targetGain = 1.0f;
+  deck.source->SetGain(deck.gain);
+  deck.source->Play(stream);
+  FrameCounters::Add(COUNTER_URHO_SETTERS, 2);
   return true;
 }
+
+void BackgroundMusicInstances::StopDeck(Deck &deck) {
+  if (deck.source) {
+    deck.source->Stop();
+  }
+  deck.stream.Reset();
+  deck.gain = 0.0f;
+  deck.targetGain = 0.0f;
+}
@@ -26,12 +26,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "SceneInstances.h"
 
-#include <Urho3D/Audio/Sound.h>
 #include <Urho3D/Audio/SoundSource.h>
 #include <Urho3D/Resource/ResourceCache.h>
 
+#include "../../../audio/MusicStream.h"
 #include "../../../components/BackgroundMusic.h"
 
+/**
+ * Streams the background music. There are two decks, each a sound source
+ * with its own stream, so that changing tracks crossfades from one deck to
+ * the other. Neither deck ever holds more than a fraction of a second of
+ * decoded audio.
+ */
 class BackgroundMusicInstances
     : public SceneInstances<BackgroundMusicInstances, BackgroundMusic,
                             Urho3D::SoundSource> {
@@ -39,7 +45,18 @@ public:
   BackgroundMusicInstances(Urho3D::Scene &scene,
                            Urho3D::ResourceCache &resources);
 
+  /// Keeps the streams fed and advances crossfades. Call once per frame.
+  void Update(float timeStep);
+
 private:
+  struct Deck {
+    Urho3D::SharedPtr<Urho3D::SoundSource> source;
+    Urho3D::SharedPtr<MusicStream> stream;
+    Urho3D::String file;
+    float gain = 0.0f;
+    float targetGain = 0.0f;
+  };
+
   virtual Urho3D::SharedPtr<Urho3D::SoundSource>
   Create(entityx::Entity entity, const BackgroundMusic &component,
          entityx::EntityManager &entities) override;
@@ -50,10 +67,14 @@ private:
 
   virtual bool DestroyInstance(Urho3D::SoundSource &instance) override;
 
-  bool PlayMusic(Urho3D::SoundSource &soundSource, const Urho3D::String file);
+  bool PlayMusic(Deck &deck, const Urho3D::String &file);
+
+  void StopDeck(Deck &deck);
 
   Urho3D::ResourceCache &mResources;
-  Urho3D::SharedPtr<Urho3D::Sound> mSound;
+  Deck mDecks[2];
+  unsigned mCurrentDeck;
+  float mCrossfadeTime;
 };
 
 #endif // NINPOTEST_BACKGROUNDMUSICINSTANCES_H
@@ -27,7 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 CameraInstances::CameraInstances(Urho3D::Scene &scene, NodeInstances &nodes,
                                  Urho3D::Context *context,
-                                 Urho3D::Renderer &renderer)
+                                 Urho3D::Renderer *renderer)
     : NodeComponentInstances(scene, nodes, "Camera"), mContext(context),
       mRenderer(renderer) {}
 
@@ -36,6 +36,9 @@ CameraInstances::CreateNodeComponent(entityx::Entity entity, Urho3D::Node &node,
                                      const Camera &component,
                                      entityx::EntityManager &entities) {
   auto camera = node.CreateComponent<Urho3D::Camera>();
+  if (!mRenderer) {
+    return Urho3D::SharedPtr<Urho3D::Camera>(camera);
+  }
   auto viewportData = entity.component<Viewport>();
 
   int viewportIndex = 0;
@@ -47,7 +50,7 @@ CameraInstances::CreateNodeComponent(entityx::Entity entity, Urho3D::Node &node,
 
   auto viewport = Urho3D::SharedPtr(
       new Urho3D::Viewport(mContext, &mScene, camera, renderPath));
-  mRenderer.SetViewport(viewportIndex, viewport);
+  mRenderer->SetViewport(viewportIndex, viewport);
   return Urho3D::SharedPtr<Urho3D::Camera>(camera);
 }
 
@@ -70,4 +73,5 @@ void CameraInstances::SyncFromData(entityx::Entity entity,
   instance.SetUseReflection(data.useReflection);
   instance.SetClipPlane(data.clipPane);
   instance.SetFlipVertical(data.flipVertical);
+  FrameCounters::Add(COUNTER_URHO_SETTERS, 16);
 }
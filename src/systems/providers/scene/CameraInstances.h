@@ -35,7 +35,7 @@ class CameraInstances
     : public NodeComponentInstances<CameraInstances, Camera, Urho3D::Camera> {
 public:
   CameraInstances(Urho3D::Scene &scene, NodeInstances &nodes,
-                  Urho3D::Context *context, Urho3D::Renderer &renderer);
+                  Urho3D::Context *context, Urho3D::Renderer *renderer);
 
 protected:
   virtual Urho3D::SharedPtr<Urho3D::Camera>
@@ -48,7 +48,8 @@ protected:
 
 private:
   Urho3D::Context *mContext;
-  Urho3D::Renderer &mRenderer;
+  // NOTE: Null when running headless, cameras then get no viewport
+  Urho3D::Renderer *mRenderer;
 };
 
 #endif // NINPOTEST_CAMERAINSTANCES_H
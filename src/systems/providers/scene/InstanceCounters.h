@@ -0,0 +1,87 @@
+/*
+------------------------------------------------------------------------------------------------------------------------
+Copyright 2019 Vite Falcon
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------------------------------------------------------
+*/
+
+#ifndef NINPOTEST_INSTANCECOUNTERS_H
+#define NINPOTEST_INSTANCECOUNTERS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Snapshot of the Urho3D objects of one type that entities hold on to through
+ * their instance components.
+ */
+struct InstanceStats {
+  const char *name;
+  std::size_t live;
+  /// Largest number of objects held at the same time.
+  std::size_t peak;
+};
+
+/**
+ * Process wide count of the scene objects held by instance components, per
+ * Urho3D type. They outlive any single game state, so objects still counted
+ * once every game state is gone have leaked.
+ *
+ * NOTE: Only the main thread creates and destroys instances, so the counters
+ * are not synchronized.
+ */
+class InstanceCounters {
+public:
+  struct Entry {
+    const char *name;
+    std::size_t live;
+    std::size_t peak;
+  };
+
+  template <typename T> static Entry &GetEntry() {
+    static Entry *entry = [] {
+      auto created = new Entry{T::GetTypeNameStatic().CString(), 0, 0};
+      Entries().push_back(created);
+      return created;
+    }();
+    return *entry;
+  }
+
+  static void Add(Entry &entry) {
+    entry.live++;
+    entry.peak = std::max(entry.peak, entry.live);
+  }
+
+  static void Remove(Entry &entry) {
+    if (entry.live > 0) {
+      entry.live--;
+    }
+  }
+
+  static void GetStats(std::vector<InstanceStats> &out);
+
+  /// Objects held across every type.
+  static std::size_t GetTotalLive();
+
+private:
+  static std::vector<Entry *> &Entries();
+};
+
+#endif // NINPOTEST_INSTANCECOUNTERS_H
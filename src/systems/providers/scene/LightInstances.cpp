@@ -44,4 +44,5 @@ void LightInstances::SyncFromData(entityx::Entity entity,
   instance.SetLength(data.length);
   instance.SetTemperature(data.temperature);
   instance.SetCastShadows(data.castShadows);
+  FrameCounters::Add(COUNTER_URHO_SETTERS, 9);
 }
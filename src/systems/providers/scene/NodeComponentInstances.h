@@ -49,8 +49,8 @@ protected:
          entityx::EntityManager &entities) override {
     Urho3D::SharedPtr<Urho3D::Node> node;
     if (!mNodes.Get(node, entity, entities)) {
-      URHO3D_LOGERRORF("Node for '%s' could not be found!",
-                       this->GetName(entity).CString());
+      GAME_LOGERRORF_LIMITED("Node for '%s' could not be found!",
+                             EntityName(entity).CString());
       return Urho3D::SharedPtr<ConcreteType>{};
     }
 
@@ -65,7 +65,7 @@ protected:
   virtual bool DestroyInstance(ConcreteType &value) override {
     auto node = value.GetNode();
     if (node == nullptr) {
-      URHO3D_LOGERRORF("Could not find node");
+      GAME_LOGERRORF("Could not find node");
       return false;
     }
     node->RemoveComponent(&value);
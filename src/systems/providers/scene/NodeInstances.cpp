@@ -40,18 +40,18 @@ NodeInstances::Create(entityx::Entity entity, const Renderable &component,
   }
   auto parentEntity = entities.get(component.parentEntityId);
   if (!parentEntity) {
-    URHO3D_LOGERRORF("Count not find parent entity ID to connect to its node "
-                     "when constructing '%s'",
-                     GetName(entity).CString());
+    GAME_LOGERRORF("Count not find parent entity ID to connect to its node "
+                   "when constructing '%s'",
+                   EntityName(entity).CString());
     return Urho3D::SharedPtr<Urho3D::Node>{};
   }
   Urho3D::SharedPtr<Urho3D::Node> parentNode;
   Urho3D::SharedPtr<Urho3D::Node> node;
   if (!Get(parentNode, parentEntity, entities)) {
-    URHO3D_LOGERRORF("Could not find the parent node (%s) create a child for "
-                     "'%s'. Defaulting to root scene node",
-                     GetName(parentEntity).CString(),
-                     GetName(entity).CString());
+    GAME_LOGERRORF("Could not find the parent node (%s) create a child for "
+                   "'%s'. Defaulting to root scene node",
+                   EntityName(parentEntity).CString(),
+                   EntityName(entity).CString());
     node = Urho3D::SharedPtr<Urho3D::Node>(mScene.CreateChild(name));
   } else {
     node = Urho3D::SharedPtr<Urho3D::Node>(parentNode->CreateChild(name));
@@ -63,21 +63,26 @@ NodeInstances::Create(entityx::Entity entity, const Renderable &component,
 
 void NodeInstances::SyncFromData(entityx::Entity entity, Urho3D::Node &instance,
                                  const Renderable &data) {
+  unsigned setters = 0;
   auto pos = entity.component<Position>();
   if (pos) {
     instance.SetPosition(pos->value);
+    ++setters;
   }
   auto dir = entity.component<Direction>();
   if (dir) {
     instance.SetRotation(dir->value);
+    ++setters;
   }
   auto scale = entity.component<Scale>();
   if (scale) {
     instance.SetScale(scale->value);
+    ++setters;
   }
+  FrameCounters::Add(COUNTER_URHO_SETTERS, setters);
 }
 
 bool NodeInstances::DestroyInstance(Urho3D::Node &instance) {
-  instance.GetParent()->RemoveChild(&instance);
+  instance.Remove();
   return true;
 }
@@ -24,20 +24,83 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_SCENEINSTANCES_H
 #define NINPOTEST_SCENEINSTANCES_H
 
+#include "../../../common/FrameCounters.h"
+#include "../../../common/GameLog.h"
 #include "../../../common/Optional.h"
 #include "../../../components/Name.h"
+#include "../../../state/FrameTracer.h"
+#include "InstanceCounters.h"
 
 #include <entityx/Entity.h>
 
 #include <Urho3D/Container/Ptr.h>
-#include <Urho3D/IO/Log.h>
 #include <Urho3D/Scene/Scene.h>
-#include <sstream>
 
+#include <cstdio>
+
+/**
+ * Name of an entity for log messages, formatted on the stack. Only make one
+ * in the arguments of a GAME_LOG macro, so that it is formatted when the
+ * message is written and not otherwise.
+ */
+class EntityName {
+public:
+  explicit EntityName(entityx::Entity entity) {
+    auto name = entity.component<Name>();
+    std::snprintf(mBuffer, sizeof(mBuffer), "[%.*s](%llu)",
+                  name ? static_cast<int>(name->value.Length()) : 7,
+                  name ? name->value.CString() : "NO-NAME",
+                  static_cast<unsigned long long>(entity.id().id()));
+  }
+
+  const char *CString() const { return mBuffer; }
+
+private:
+  char mBuffer[64];
+};
+
+/**
+ * Holds the Urho3D object made for one of the entity's components. Every
+ * holder of an object is counted, see InstanceCounters.
+ */
 template <typename ConcreteType> struct InstanceComponent {
-  InstanceComponent(Urho3D::SharedPtr<ConcreteType> value) : value(value) {}
+  InstanceComponent(Urho3D::SharedPtr<ConcreteType> value) : value(value) {
+    Track();
+  }
+
+  InstanceComponent(const InstanceComponent &other) : value(other.value) {
+    Track();
+  }
+
+  InstanceComponent &operator=(const InstanceComponent &other) {
+    Untrack();
+    value = other.value;
+    Track();
+    return *this;
+  }
+
+  ~InstanceComponent() { Untrack(); }
+
+  /// Lets go of the object, e.g. once it has been destroyed.
+  void Reset() {
+    Untrack();
+    value.Reset();
+  }
 
   Urho3D::SharedPtr<ConcreteType> value;
+
+private:
+  void Track() {
+    if (value) {
+      InstanceCounters::Add(InstanceCounters::GetEntry<ConcreteType>());
+    }
+  }
+
+  void Untrack() {
+    if (value) {
+      InstanceCounters::Remove(InstanceCounters::GetEntry<ConcreteType>());
+    }
+  }
 };
 
 template <class DerivedType, typename ComponentType, typename ConcreteType,
@@ -45,7 +108,8 @@ template <class DerivedType, typename ComponentType, typename ConcreteType,
 class SceneInstances : public entityx::Receiver<DerivedType> {
 public:
   SceneInstances(Urho3D::Scene &scene, Urho3D::String instanceName)
-      : mScene(scene), mInstanceName(instanceName) {}
+      : mScene(scene), mInstanceName(instanceName),
+        mCreateTraceName(FrameTracer::Intern(instanceName + "::Create")) {}
   virtual ~SceneInstances() = default;
 
   void Configure(entityx::EventManager &eventManager) {
@@ -85,16 +149,26 @@ public:
       return false;
     }
 
+    // NOTE: Creating an instance is where the resources get loaded
+    TRACE_SCOPE(mCreateTraceName);
     auto instanceComponent =
         CreateInstanceComponent(entity, *component, entities);
     if (!instanceComponent.value) {
-      URHO3D_LOGERRORF("Failed to create concrete instance of type '%s'",
-                       GetName(entity).CString());
+      // NOTE: Limited, the creation is retried on every sync
+      GAME_LOGERRORF_LIMITED("Failed to create concrete instance of type '%s'",
+                             EntityName(entity).CString());
       return false;
     }
-    entity.assign_from_copy(instanceComponent);
+    auto existing = entity.component<InstanceComponentType>();
+    if (existing) {
+      // Left behind, empty, when the previous instance was destroyed
+      *existing = instanceComponent;
+    } else {
+      entity.assign_from_copy(instanceComponent);
+    }
+    FrameCounters::Add(COUNTER_INSTANCES_CREATED);
     out = instanceComponent.value;
-    URHO3D_LOGDEBUGF("Loaded '%s' instance", GetName(entity).CString());
+    GAME_LOGDEBUGF("Loaded '%s' instance", EntityName(entity).CString());
     return true;
   }
 
@@ -106,45 +180,40 @@ public:
 
     Urho3D::SharedPtr<ConcreteType> instance;
     if (!Get(instance, entity, entities)) {
-      URHO3D_LOGERRORF("Failed to find concrete instance for component '%s'",
-                       GetName(entity).CString());
+      GAME_LOGERRORF_LIMITED(
+          "Failed to find concrete instance for component '%s'",
+          EntityName(entity).CString());
       return;
     }
 
+    FrameCounters::Add(COUNTER_SYNCS);
     SyncFromData(entity, *instance, *data);
   }
 
   void Destroy(entityx::Entity entity) {
     auto instance = entity.component<InstanceComponentType>();
     if (!instance || !instance->value) {
-      URHO3D_LOGINFOF("The concrete instance for '%s' could not be found",
-                      GetName(entity).CString());
+      GAME_LOGINFOF("The concrete instance for '%s' could not be found",
+                    EntityName(entity).CString());
       return;
     }
-    URHO3D_LOGDEBUGF("Destroying '%s'", GetName(entity).CString());
-    if (!DestroyInstance(*(instance->value))) {
-      URHO3D_LOGERRORF("Failed to cleanly clean up entity: '%s'", GetName(entity).CString());
-    }
-  }
-
-protected:
-  Urho3D::String GetName(entityx::Entity& entity) {
-#ifdef URHO3D_LOGGING
-    std::stringstream nameBuilder;
-    nameBuilder << "[";
-    auto nameComponent = entity.component<Name>();
-    if (nameComponent) {
-      nameBuilder << nameComponent->value.CString();
+    if (instance->value->GetScene() == nullptr) {
+      // The instance already left the scene along with one of its ancestors
+      ReleaseInstance(*(instance->value));
     } else {
-      nameBuilder << "NO-NAME";
+      GAME_LOGDEBUGF("Destroying '%s'", EntityName(entity).CString());
+      if (!DestroyInstance(*(instance->value))) {
+        GAME_LOGERRORF("Failed to cleanly clean up entity: '%s'",
+                       EntityName(entity).CString());
+      }
     }
-    nameBuilder << "](" << entity.id().id() << ")";
-    return Urho3D::String{nameBuilder.str().c_str()};
-#else
-    return Urho3D::String{entity.id().id()};
-#endif
+    // NOTE: The instance component itself can't be removed here, entityx may
+    // be removing every component of the entity. Emptying it is enough for
+    // the entity to get a new instance if the component comes back.
+    instance->Reset();
   }
 
+protected:
   Urho3D::String GetAssignedName(entityx::Entity entity) {
     auto name = entity.component<Name>();
     if (name) {
@@ -170,9 +239,17 @@ protected:
 
   virtual bool DestroyInstance(ConcreteType &instance) = 0;
 
+  /**
+   * Called instead of DestroyInstance when the instance is no longer part of
+   * the scene, e.g. when an ancestor node was removed. Only bookkeeping is
+   * needed here.
+   */
+  virtual void ReleaseInstance(ConcreteType &instance) {}
+
 protected:
   Urho3D::Scene &mScene;
   Urho3D::String mInstanceName;
+  const char *mCreateTraceName;
 };
 
 #endif // NINPOTEST_SCENEINSTANCES_H
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include "SoundInstances.h"
+#include "../../../audio/SoundBank.h"
 
 #include <Urho3D/Audio/AudioEvents.h>
 #include <Urho3D/Audio/Sound.h>
@@ -31,32 +32,56 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <Urho3D/Scene/SceneEvents.h>
 
 SoundInstances::SoundInstances(Urho3D::Scene &scene, NodeInstances &nodes,
-                               Urho3D::ResourceCache &resources)
-    : NodeComponentInstances(scene, nodes, "Sound"), mResources(resources) {}
+                               Urho3D::ResourceCache &resources,
+                               Urho3D::Audio *audio,
+                               const VoiceSettings &voiceSettings)
+    : NodeComponentInstances(scene, nodes, "Sound"), mResources(resources),
+      mVoices(audio, voiceSettings) {}
+
+void SoundInstances::Configure(entityx::EventManager &eventManager) {
+  NodeComponentInstances::Configure(eventManager);
+  eventManager.subscribe<SoundParkedEvent>(*this);
+  eventManager.subscribe<SoundReplayedEvent>(*this);
+}
+
+void SoundInstances::receive(const SoundParkedEvent &event) {
+  auto source = GetIfExists(event.entity);
+  if (source) {
+    // A parked sound doesn't take up a voice until it is replayed
+    mVoices.Remove(*source);
+  }
+}
+
+void SoundInstances::receive(const SoundReplayedEvent &event) {
+  auto entity = event.entity;
+  auto source = GetIfExists(entity);
+  auto component = entity.component<Sound>();
+  if (!source || !component) {
+    return;
+  }
+  auto sound = ResolveSound(*component);
+  if (sound) {
+    Start(entity, *source, *sound, *component);
+  }
+}
 
 Urho3D::SharedPtr<Urho3D::SoundSource3D>
 SoundInstances::CreateNodeComponent(entityx::Entity entity, Urho3D::Node &node,
                                     const Sound &component,
                                     entityx::EntityManager &entities) {
-  auto sound = mResources.GetResource<Urho3D::Sound>(component.value);
+  auto sound = ResolveSound(component);
   if (!sound) {
-    URHO3D_LOGERRORF("Failed to load sound: %s", component.value.CString());
     return Urho3D::SharedPtr<Urho3D::SoundSource3D>{};
   }
 
   Urho3D::SharedPtr<Urho3D::SoundSource3D> source(
       node.CreateComponent<Urho3D::SoundSource3D>());
   if (!source) {
-    URHO3D_LOGERROR("Failed to create sound source 3D");
+    GAME_LOGERRORF("Failed to create sound source 3D");
     return Urho3D::SharedPtr<Urho3D::SoundSource3D>{};
   }
-  mSounds[source->GetID()] = entity;
-  sound->SetLooped(component.isLooped);
-  SyncFromData(entity, *source, component);
-  source->Play(sound);
-
-  URHO3D_LOGDEBUGF("Added sound '%s' to entity ID: '%s'",
-                   sound->GetName().CString(), this->GetName(entity).CString());
+  mSounds[source.Get()] = entity;
+  Start(entity, *source, *sound, component);
   return source;
 }
 
@@ -66,17 +91,60 @@ void SoundInstances::SyncFromData(entityx::Entity entity,
   source.SetNearDistance(data.nearDistance);
   source.SetFarDistance(data.farDistance);
   source.SetSoundType(data.type);
-  source.SetEnabled(data.isEnabled);
+  // NOTE: A virtual voice has its source disabled so that it isn't mixed
+  source.SetEnabled(data.isEnabled && !mVoices.IsVirtual(source));
   source.SetGain(data.gain);
+  FrameCounters::Add(COUNTER_URHO_SETTERS, 5);
 }
 
 bool SoundInstances::DestroyInstance(Urho3D::SoundSource3D &value) {
-  auto itr = mSounds.Find(value.GetID());
+  Forget(value);
+  return NodeComponentInstances::DestroyInstance(value);
+}
+
+void SoundInstances::ReleaseInstance(Urho3D::SoundSource3D &value) {
+  Forget(value);
+}
+
+Urho3D::Sound *SoundInstances::ResolveSound(const Sound &component) {
+  if (component.handle.IsValid()) {
+    auto bank = mScene.GetSubsystem<SoundBank>();
+    auto sound = bank ? bank->Get(component.handle) : nullptr;
+    if (!sound) {
+      GAME_LOGERRORF("Sound bank has no sound with handle %u",
+                     component.handle.index);
+    }
+    return sound;
+  }
+  FrameCounters::Add(COUNTER_RESOURCE_LOOKUPS);
+  auto sound = mResources.GetResource<Urho3D::Sound>(component.value);
+  if (!sound) {
+    GAME_LOGERRORF("Failed to load sound: %s", component.value.CString());
+  }
+  return sound;
+}
+
+void SoundInstances::Start(entityx::Entity entity,
+                           Urho3D::SoundSource3D &source, Urho3D::Sound &sound,
+                           const Sound &component) {
+  sound.SetLooped(component.isLooped);
+  SyncFromData(entity, source, component);
+  // NOTE: Added before playing so that a voice starting out virtual is never
+  // mixed
+  mVoices.Add(source, component.priority);
+  source.Play(&sound);
+
+  GAME_LOGDEBUGF("Playing sound '%s' on entity ID: '%s'",
+                 sound.GetName().CString(), EntityName(entity).CString());
+}
+
+void SoundInstances::Forget(Urho3D::SoundSource3D &value) {
+  mVoices.Remove(value);
+  auto itr = mSounds.Find(&value);
   if (itr == mSounds.End()) {
-    URHO3D_LOGERRORF("Failed to find entity playing sound: %s",
-                     value.GetSound()->GetName().CString());
+    GAME_LOGERRORF("Failed to find entity playing sound: %s",
+                   value.GetSound()->GetName().CString());
   } else {
     mSounds.Erase(itr);
   }
-  return NodeComponentInstances::DestroyInstance(value);
 }
@@ -24,7 +24,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #ifndef NINPOTEST_SOUNDINSTANCES_H
 #define NINPOTEST_SOUNDINSTANCES_H
 
+#include "../../../audio/VoiceManager.h"
+#include "../../../common/FlatHashMap.h"
 #include "../../../components/Sound.h"
+#include "../../../events/SoundEvents.h"
 #include "NodeComponentInstances.h"
 #include "SceneInstances.h"
 
@@ -36,7 +39,21 @@ class SoundInstances : public NodeComponentInstances<SoundInstances, Sound,
                                                      Urho3D::SoundSource3D> {
 public:
   SoundInstances(Urho3D::Scene &scene, NodeInstances &nodes,
-                 Urho3D::ResourceCache &resources);
+                 Urho3D::ResourceCache &resources, Urho3D::Audio *audio,
+                 const VoiceSettings &voiceSettings);
+
+  void Configure(entityx::EventManager &eventManager);
+
+  using NodeComponentInstances::receive;
+
+  void receive(const SoundParkedEvent &event);
+
+  void receive(const SoundReplayedEvent &event);
+
+  /// Re-evaluates which voices get mixed. Call once per frame.
+  void UpdateVoices(float timeStep) { mVoices.Update(timeStep); }
+
+  VoiceManager &GetVoices() { return mVoices; }
 
 protected:
   virtual Urho3D::SharedPtr<Urho3D::SoundSource3D>
@@ -50,9 +67,21 @@ protected:
 
   virtual bool DestroyInstance(Urho3D::SoundSource3D &value) override;
 
+  virtual void ReleaseInstance(Urho3D::SoundSource3D &value) override;
+
 private:
+  Urho3D::Sound *ResolveSound(const Sound &component);
+
+  void Start(entityx::Entity entity, Urho3D::SoundSource3D &source,
+             Urho3D::Sound &sound, const Sound &component);
+
+  void Forget(Urho3D::SoundSource3D &value);
+
   Urho3D::ResourceCache &mResources;
-  Urho3D::HashMap<unsigned int, entityx::Entity> mSounds;
+  // NOTE: Keyed by the source itself, component IDs are reset once a node
+  // leaves the scene
+  FlatHashMap<Urho3D::SoundSource3D *, entityx::Entity> mSounds;
+  VoiceManager mVoices;
 };
 
 #endif // NINPOTEST_SOUNDINSTANCES_H
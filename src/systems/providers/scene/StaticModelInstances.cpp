@@ -25,7 +25,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <Urho3D/Graphics/Material.h>
 #include <Urho3D/Graphics/Model.h>
-#include <Urho3D/IO/Log.h>
 
 StaticModelInstances::StaticModelInstances(Urho3D::Scene &scene,
                                            NodeInstances nodes,
@@ -45,29 +44,36 @@ StaticModelInstances::CreateNodeComponent(entityx::Entity entity,
 void StaticModelInstances::SyncFromData(entityx::Entity entity,
                                         Urho3D::StaticModel &instance,
                                         const StaticModel &data) {
+  // NOTE: A model or material that failed to load is looked up again on
+  // every sync, hence the limited error messages
   if (!data.model.Empty() && (instance.GetModel() == nullptr ||
                               instance.GetModel()->GetName() != data.model)) {
-    URHO3D_LOGDEBUGF("Loading static model: %s", data.model.CString());
+    GAME_LOGDEBUGF("Loading static model: %s", data.model.CString());
+    FrameCounters::Add(COUNTER_RESOURCE_LOOKUPS);
     auto model = mResources.GetResource<Urho3D::Model>(data.model);
     if (nullptr == model) {
-      URHO3D_LOGERRORF("Failed to load static model: %s", data.model.CString());
+      GAME_LOGERRORF_LIMITED("Failed to load static model: %s",
+                             data.model.CString());
     }
     // NOTE: We are setting the model even if failed to load so that the error
     // is obvious
     instance.SetModel(model);
+    FrameCounters::Add(COUNTER_URHO_SETTERS);
   }
 
   if (!data.material.Empty() &&
       (instance.GetMaterial() == nullptr ||
        instance.GetMaterial()->GetName() != data.material)) {
-    URHO3D_LOGDEBUGF("Loading static material: %s", data.material.CString());
+    GAME_LOGDEBUGF("Loading static material: %s", data.material.CString());
+    FrameCounters::Add(COUNTER_RESOURCE_LOOKUPS);
     auto material = mResources.GetResource<Urho3D::Material>(data.material);
     if (material == nullptr) {
-      URHO3D_LOGERRORF("Failed to load static material: %s",
-                       data.model.CString());
+      GAME_LOGERRORF_LIMITED("Failed to load static material: %s",
+                             data.material.CString());
     }
     // NOTE: We are setting the material even if failed to load so that the
     // error is obvious
     instance.SetMaterial(material);
+    FrameCounters::Add(COUNTER_URHO_SETTERS);
   }
 }
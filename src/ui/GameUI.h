@@ -19,8 +19,9 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef NINPOTEST_GAMEUI_H
 #define NINPOTEST_GAMEUI_H
 
+#include "../common/FlatHashMap.h"
+
 #include <Urho3D/Core/Object.h>
-#include <Urho3D/Container/HashMap.h>
 #include <Urho3D/Container/HashSet.h>
 #include <Urho3D/UI/UI.h>
 #include <Urho3D/UI/UIElement.h>
@@ -37,15 +38,18 @@ protected:
   void setNamedElement(Urho3D::String name, Urho3D::UIElement* element, bool addAsRootElement=false);
 
   template <typename T>
-  T* getNamedElement(Urho3D::String name) {
-    auto element = mNamedElement[name];
-    return static_cast<T*>(element);
+  T* getNamedElement(const char* name) {
+    auto itr = mNamedElement.Find(name);
+    if (itr == mNamedElement.End()) {
+      return nullptr;
+    }
+    return static_cast<T*>(itr->second);
   }
 
 private:
   Urho3D::UI& getUI();
 
-  Urho3D::HashMap<Urho3D::String, Urho3D::UIElement*> mNamedElement;
+  FlatHashMap<Urho3D::String, Urho3D::UIElement*, StringKeyHash, StringKeyEqual> mNamedElement;
   Urho3D::HashSet<Urho3D::UIElement*> mElements;
 };
 
@@ -22,9 +22,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #include "StatusOverlay.h"
-
-#include <sstream>
-#include <string>
+#include "../state/FrameArena.h"
+#include "../state/MemoryMonitor.h"
 
 #include <Urho3D/Core/CoreEvents.h>
 #include <Urho3D/Math/Color.h>
@@ -33,12 +32,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <Urho3D/UI/Text.h>
 #include <Urho3D/UI/UI.h>
 
+#include <algorithm>
+
 #define STATUS_OVERLAY_FIRST_LINE                                              \
   "Keys: tab = toggle mouse, AWSD = move camera, Shift = fast mode, Esc = "    \
   "quit, Space = EXPLOSIONS!\n"
 
 StatusOverlay::StatusOverlay(Urho3D::Context *context)
-    : GameUI(context), mFrameCount(0), mTime(0.0f) {
+    : GameUI(context), mFrameCount(0), mTime(0.0f), mProfileTime(0.0f),
+      mFrameTimes(), mSortedFrameTimes(), mNextFrame(0), mFrameTimeCount(0),
+      mHasFrameStart(false), mScratch(4096) {
   Urho3D::ResourceCache *cache = GetSubsystem<Urho3D::ResourceCache>();
   Urho3D::Text *text = new Urho3D::Text(context);
   // Text will be updated later in the E_UPDATE handler. Keep readin'.
@@ -54,6 +57,33 @@ StatusOverlay::StatusOverlay(Urho3D::Context *context)
 
   setNamedElement("text", text, true);
 
+  Urho3D::Text *pools = new Urho3D::Text(context);
+  pools->SetFont(cache->GetResource<Urho3D::Font>("Fonts/Anonymous Pro.ttf"),
+                 11);
+  pools->SetColor(Urho3D::Color(.3, 0, .3));
+  pools->SetHorizontalAlignment(Urho3D::HA_RIGHT);
+  pools->SetVerticalAlignment(Urho3D::VA_TOP);
+
+  setNamedElement("pools", pools, true);
+
+  Urho3D::Text *profile = new Urho3D::Text(context);
+  profile->SetFont(cache->GetResource<Urho3D::Font>("Fonts/Anonymous Pro.ttf"),
+                   11);
+  profile->SetColor(Urho3D::Color(.3, 0, .3));
+  profile->SetHorizontalAlignment(Urho3D::HA_LEFT);
+  profile->SetVerticalAlignment(Urho3D::VA_TOP);
+
+  setNamedElement("profile", profile, true);
+
+  Urho3D::Text *memory = new Urho3D::Text(context);
+  memory->SetFont(cache->GetResource<Urho3D::Font>("Fonts/Anonymous Pro.ttf"),
+                  11);
+  memory->SetColor(Urho3D::Color(.3, 0, .3));
+  memory->SetHorizontalAlignment(Urho3D::HA_RIGHT);
+  memory->SetVerticalAlignment(Urho3D::VA_BOTTOM);
+
+  setNamedElement("memory", memory, true);
+
   SubscribeToEvent(Urho3D::E_UPDATE,
                    URHO3D_HANDLER(StatusOverlay, HandleUpdate));
 }
@@ -61,38 +91,176 @@ StatusOverlay::StatusOverlay(Urho3D::Context *context)
 void StatusOverlay::HandleUpdate(Urho3D::StringHash eventType,
                                  Urho3D::VariantMap &eventData) {
   float timeStep = eventData[Urho3D::Update::P_TIMESTEP].GetFloat();
+  RecordFrameTime();
   mFrameCount++;
   mTime += timeStep;
+  mProfileTime += timeStep;
 
-  if (mTime < 1) {
+  if (mTime < 1 && mProfileTime < 0.25f) {
     return;
   }
 
-  std::string str;
-  str.append(STATUS_OVERLAY_FIRST_LINE);
-  {
-    std::ostringstream ss;
-    ss << mFrameCount;
-    std::string s(ss.str());
-    str.append(s.substr(0, 6));
+  auto frameArena = GetSubsystem<FrameArena>();
+  if (!frameArena) {
+    mScratch.Reset();
   }
-  str.append(" frames in ");
-  {
-    std::ostringstream ss;
-    ss << mTime;
-    std::string s(ss.str());
-    str.append(s.substr(0, 6));
+  auto &arena = frameArena ? frameArena->GetArena() : mScratch;
+
+  // The profile covers a sliding window, it is refreshed more often
+  if (mProfileTime >= 0.25f) {
+    mProfileTime = 0;
+    UpdateProfile(arena);
   }
-  str.append(" seconds = ");
-  {
-    std::ostringstream ss;
-    ss << (float)mFrameCount / mTime;
-    std::string s(ss.str());
-    str.append(s.substr(0, 6));
+  if (mTime < 1) {
+    return;
   }
-  str.append(" fps");
-  Urho3D::String s(str.c_str(), str.size());
-  getNamedElement<Urho3D::Text>("text")->SetText(s);
+
+  ArenaStringBuilder str(arena, 1024);
+  str.Append(STATUS_OVERLAY_FIRST_LINE);
+  str.AppendFormat("%d frames in %.4g seconds = %.5g fps\n", mFrameCount,
+                   mTime, mFrameCount / mTime);
+  UpdateFrameStats(str);
+  SetText("text", mStatusText, str);
   mFrameCount = 0;
   mTime = 0;
+
+  UpdatePoolStats(arena);
+  UpdateMemory(arena);
+}
+
+void StatusOverlay::RecordFrameTime() {
+  auto microseconds = mFrameTimer.GetUSec(true);
+  // The time until the first update is spent loading, not rendering
+  if (!mHasFrameStart) {
+    mHasFrameStart = true;
+    return;
+  }
+  mFrameTimes[mNextFrame] = microseconds / 1000.0f;
+  mNextFrame = (mNextFrame + 1) % FRAME_HISTORY;
+  mFrameTimeCount = std::min(mFrameTimeCount + 1, FRAME_HISTORY);
+}
+
+void StatusOverlay::UpdateFrameStats(ArenaStringBuilder &str) {
+  if (mFrameTimeCount == 0) {
+    return;
+  }
+  const auto count = mFrameTimeCount;
+  auto begin = mSortedFrameTimes.begin();
+  auto end = std::copy(mFrameTimes.begin(), mFrameTimes.begin() + count, begin);
+  std::sort(begin, end);
+  float total = 0.0f;
+  for (auto itr = begin; itr != end; ++itr) {
+    total += *itr;
+  }
+  // Nearest rank
+  auto percentile = [&](unsigned p) {
+    return begin[(count * p + 99) / 100 - 1];
+  };
+  const float median = percentile(50);
+  const float hitchTime = median * HITCH_FACTOR;
+  auto hitches = end - std::upper_bound(begin, end, hitchTime);
+  str.AppendFormat("Frame ms over %u frames: avg %.2f  p50 %.2f  p95 %.2f  "
+                   "p99 %.2f  max %.2f  hitches (>%.1f) %d\n",
+                   count, total / count, median, percentile(95),
+                   percentile(99), end[-1], hitchTime,
+                   static_cast<int>(hitches));
+
+  // Frame time histogram, in milliseconds; 16.7 and 33.3 are 60 and 30 fps
+  static const float BUCKET_LIMITS[] = {8.4f, 16.7f, 33.3f, 50.0f, 100.0f};
+  static const char *BUCKET_NAMES[] = {"<8",   "<17",  "<33",
+                                       "<50",  "<100", ">=100"};
+  static const char BAR[] = "########################################";
+  const int BAR_WIDTH = static_cast<int>(sizeof(BAR) - 1);
+  constexpr unsigned BUCKETS = sizeof(BUCKET_NAMES) / sizeof(*BUCKET_NAMES);
+  unsigned buckets[BUCKETS] = {};
+  auto lower = begin;
+  for (unsigned i = 0; i < BUCKETS; ++i) {
+    auto upper = i + 1 < BUCKETS
+                     ? std::lower_bound(lower, end, BUCKET_LIMITS[i])
+                     : end;
+    buckets[i] = static_cast<unsigned>(upper - lower);
+    lower = upper;
+  }
+  auto largest = *std::max_element(buckets, buckets + BUCKETS);
+  for (unsigned i = 0; i < BUCKETS; ++i) {
+    // Every non-empty bucket gets at least one mark, a single hitch matters
+    int width = buckets[i] == 0 ? 0
+                                : std::max(1u, buckets[i] * BAR_WIDTH / largest);
+    str.AppendFormat("%6s ms %-*.*s %u\n", BUCKET_NAMES[i], BAR_WIDTH, width,
+                     BAR, buckets[i]);
+  }
+}
+
+void StatusOverlay::UpdatePoolStats(LinearArena &arena) {
+  ComponentPools::GetStats(mPoolStats);
+  ArenaStringBuilder str(arena, 64 * (mPoolStats.size() + 2));
+  str.Append("Component        live    peak     cap     KiB\n");
+  std::size_t totalBytes = 0;
+  for (const auto &stats : mPoolStats) {
+    str.AppendFormat("%-14s%7zu%8zu%8zu%8zu\n", stats.name, stats.live,
+                     stats.highWaterMark, stats.capacity, stats.bytes / 1024);
+    totalBytes += stats.bytes;
+  }
+  str.AppendFormat("Total%40zu", totalBytes / 1024);
+  SetText("pools", mPoolsText, str);
+}
+
+void StatusOverlay::UpdateProfile(LinearArena &arena) {
+  auto profiler = GetSubsystem<FrameProfiler>();
+  if (!profiler) {
+    getNamedElement<Urho3D::Text>("profile")->SetText(Urho3D::String::EMPTY);
+    return;
+  }
+  profiler->GetStats(mProfileStats);
+  FrameCounters::GetStats(mCounterStats);
+  ArenaStringBuilder str(
+      arena, 80 * (mProfileStats.size() + mCounterStats.size() + 2));
+  str.AppendFormat("%-30s%8s%8s%8s%8s\n", "Section (ms)", "min", "avg", "max",
+                   "p99");
+  for (const auto &stats : mProfileStats) {
+    if (stats.samples == 0) {
+      continue;
+    }
+    str.AppendFormat("%-30.30s%8.3f%8.3f%8.3f%8.3f\n", stats.name, stats.min,
+                     stats.avg, stats.max, stats.p99);
+  }
+  str.AppendFormat("%-30s%8s%8s%8s\n", "Counter", "frame", "avg", "peak");
+  for (const auto &stats : mCounterStats) {
+    str.AppendFormat("%-30.30s%8llu%8.1f%8llu\n", stats.name, stats.lastFrame,
+                     stats.perFrame, stats.peak);
+  }
+  SetText("profile", mProfileText, str);
+}
+
+void StatusOverlay::UpdateMemory(LinearArena &arena) {
+  InstanceCounters::GetStats(mInstanceStats);
+  ArenaStringBuilder str(arena, 48 * (mInstanceStats.size() + 8));
+  auto monitor = GetSubsystem<MemoryMonitor>();
+  if (monitor) {
+    MemoryStats stats;
+    monitor->GetStats(stats);
+    str.AppendFormat("Resident%16zu KiB\n", stats.residentBytes / 1024);
+    str.AppendFormat("Resources%15zu KiB\n", stats.resourceBytes / 1024);
+    str.AppendFormat("Pools%19zu KiB\n", stats.poolBytes / 1024);
+    str.AppendFormat("Strings%17zu KiB\n", stats.stringBytes / 1024);
+    str.AppendFormat("Nodes%19zu\n", stats.nodes);
+    str.AppendFormat("Drawables%15zu\n", stats.drawables);
+  } else {
+    str.AppendFormat("Resident%16zu KiB\n",
+                     MemoryMonitor::GetResidentBytes() / 1024);
+  }
+  str.Append("Instance          live    peak\n");
+  for (const auto &stats : mInstanceStats) {
+    str.AppendFormat("%-14.14s%8zu%8zu\n", stats.name, stats.live, stats.peak);
+  }
+  SetText("memory", mMemoryText, str);
+}
+
+void StatusOverlay::SetText(const char *element, Urho3D::String &buffer,
+                            const ArenaStringBuilder &str) {
+  // NOTE: Clearing keeps the capacity, so after the first few updates this
+  // only copies
+  buffer.Clear();
+  buffer.Append(str.CString(), static_cast<unsigned>(str.Length()));
+  getNamedElement<Urho3D::Text>(element)->SetText(buffer);
 }
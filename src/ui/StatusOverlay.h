@@ -25,18 +25,67 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define NINPOTEST_STATUSOVERLAY_H
 
 #include "GameUI.h"
+#include "../common/Arena.h"
+#include "../common/ComponentPool.h"
+#include "../common/FrameCounters.h"
+#include "../state/FrameProfiler.h"
+#include "../systems/providers/scene/InstanceCounters.h"
+
+#include <Urho3D/Core/Timer.h>
+
+#include <array>
+#include <vector>
 
 class StatusOverlay : public GameUI {
   GAME_UI(StatusOverlay)
 public:
+  /// Frames kept for the frame time statistics, about 10 seconds at 60 fps.
+  static constexpr unsigned FRAME_HISTORY = 600;
+  /// Frames taking longer than this many times the median are hitches.
+  static constexpr float HITCH_FACTOR = 2.0f;
+
   StatusOverlay(Urho3D::Context *context);
 
 private:
   void HandleUpdate(Urho3D::StringHash eventType,
                     Urho3D::VariantMap &eventData);
 
+  void RecordFrameTime();
+
+  void UpdateFrameStats(ArenaStringBuilder &str);
+
+  void UpdatePoolStats(LinearArena &arena);
+
+  void UpdateProfile(LinearArena &arena);
+
+  void UpdateMemory(LinearArena &arena);
+
+  /// Sets the text of an element without allocating once `buffer` is big
+  /// enough.
+  void SetText(const char *element, Urho3D::String &buffer,
+               const ArenaStringBuilder &str);
+
   int mFrameCount;
   float mTime;
+  float mProfileTime;
+  /// Wall clock time of the last frames in milliseconds. The engine's time
+  /// step is smoothed, which would hide hitches.
+  std::array<float, FRAME_HISTORY> mFrameTimes;
+  std::array<float, FRAME_HISTORY> mSortedFrameTimes;
+  unsigned mNextFrame;
+  unsigned mFrameTimeCount;
+  bool mHasFrameStart;
+  Urho3D::HiresTimer mFrameTimer;
+  Urho3D::String mStatusText;
+  Urho3D::String mPoolsText;
+  Urho3D::String mProfileText;
+  Urho3D::String mMemoryText;
+  std::vector<ComponentPoolStats> mPoolStats;
+  std::vector<ProfileStats> mProfileStats;
+  std::vector<FrameCounterStats> mCounterStats;
+  std::vector<InstanceStats> mInstanceStats;
+  // NOTE: Only used when no game state, and hence no FrameArena, is around.
+  LinearArena mScratch;
 };
 
 #endif // NINPOTEST_STATUSOVERLAY_H